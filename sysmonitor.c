@@ -10,6 +10,8 @@
 
  */
 
+#define _GNU_SOURCE     // wcwidth()
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,23 +23,128 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <ctype.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <linux/io_uring.h>
+#include <pwd.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <sys/ioctl.h>
+#include <locale.h>
+#include <wchar.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 
 // ==================== SHARED COMPONENTS ====================
 
 // Global variables
 FILE *logFile = NULL;
 volatile sig_atomic_t running = 1;
+volatile sig_atomic_t caughtSignal = 0;
 
 // Function prototypes
 void getCPUUsage();
 void getMemoryUsage();
+void getDiskUsage();
+void getNetworkUsage();
+void getPressure();
 void listTopProcesses();
-void continuousMonitor(int interval);
+void listTopCgroups();
+void continuousMonitor(double interval);
 void displayMenu();
 void handleSignal(int sig);
 void writeLog(const char *message);
+void reportError(const char *fmt, ...);
+void reportErrno(const char *message);
 char* getCurrentTimestamp();
 void displayHelp();
+void cleanupResources();
+void runBenchmark(const char *name);
+
+/*
+ * Display output sink. Modules print through emit(), which goes to
+ * stdout, or into the frame being composed while continuous mode builds
+ * one (see renderFrame()).
+ */
+struct FrameBuffer {
+    char *data;
+    size_t len;
+    size_t cap;
+    int active;         // emit() appends here instead of printing
+};
+
+void emit(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// printf-free formatters for the hot display paths; a negative width
+// left-aligns like printf's "-" flag
+void emitText(const char *text, size_t len);
+void emitString(const char *str);
+void emitClipped(const char *str, size_t max);
+void emitPadded(const char *str, int width);
+void emitUnsigned(unsigned long long value, int width);
+void emitSigned(long long value, int width);
+void emitFixed(double value, int decimals, int width);
+
+// Time spent formatting display output, reported per frame
+struct FrameStats {
+    double format_us;       // Formatting time of the frame being composed
+    double last_format_us;  // ... of the previous frame
+    double last_render_us;  // Diff and write() of the previous frame
+    size_t last_bytes;      // Size of the previous frame
+    size_t last_written;    // Bytes sent to the terminal for it
+    unsigned long frames;
+    double total_format_us;
+    double total_render_us;
+};
+
+// Persistent handle on a /proc file that is re-read in place every sample
+struct ProcSource {
+    const char *path;
+    int fd;             // -1 until first read or after a failed read
+    char *buf;          // Grown on demand so large files are never truncated
+    size_t cap;
+};
+
+#define PROC_SOURCE_INIT(p) { (p), -1, NULL, 0 }
+#define PROC_SOURCE_MIN_BUF 4096
+
+ssize_t readProcSource(struct ProcSource *src);
+void closeProcSource(struct ProcSource *src);
+void sanitizeText(char *text, size_t len);
+
+// Read cursor over a /proc buffer, shared by every /proc parser. Parsing
+// is hand-written (no sscanf/strtol format or locale handling, no
+// allocation) and unsigned numbers are overflow-checked.
+struct ProcCursor {
+    const char *p;      // Next unread byte
+    const char *end;    // One past the last byte
+};
+
+// Bounded top-K selector: a min-heap of small (key, id) pairs fed one
+// candidate at a time, so ranking n items costs O(n log k)
+struct TopKEntry {
+    double key;                 // Primary ranking key (larger ranks higher)
+    unsigned long long tie;     // Secondary key for equal primary keys
+    int id;                     // Caller-defined identifier (e.g. PID)
+};
+
+struct TopK {
+    struct TopKEntry *heap;
+    int size;
+    int k;
+    int capacity;
+};
+
+int resetTopK(struct TopK *top, int k);
+void offerTopK(struct TopK *top, double key, unsigned long long tie, int id);
+int finishTopK(struct TopK *top);
+void freeTopK(struct TopK *top);
 
 // ==================== SHARED HELPER FUNCTIONS ====================
 
@@ -67,23 +174,577 @@ void writeLog(const char *message) {
     fflush(logFile);
 }
 
+/*
+ * Module errors go to stderr, except while continuous mode owns the
+ * screen: stderr shares the terminal, and text written there lands in
+ * the middle of the frame. Then they are logged instead and the latest
+ * one is shown in the next frame's footer (see reportFrameStats()).
+ */
+static int errorsToLog;
+static char lastError[256];
+
 /**
- * handleSignal - Signal handler for graceful shutdown
- * @sig: Signal number
+ * reportError - Report a module error (printf-style format)
+ *
+ * Prints the message to stderr, or while the renderer owns the screen
+ * writes it to the log (without its newline) and keeps it for the next
+ * frame's footer, so it cannot land in the middle of the frame.
  */
-void handleSignal(int sig) {
-    if (sig == SIGINT) {
-        running = 0;
-        printf("\n\nExiting... Saving log.\n");
-        writeLog("SIGINT received");
-        writeLog("Session ended");
+void reportError(const char *fmt, ...) {
+    va_list args;
+    
+    if (!errorsToLog) {
+        va_start(args, fmt);
+        vfprintf(stderr, fmt, args);
+        va_end(args);
+        return;
+    }
+    
+    va_start(args, fmt);
+    vsnprintf(lastError, sizeof(lastError), fmt, args);
+    va_end(args);
+    lastError[strcspn(lastError, "\n")] = '\0';
+    writeLog(lastError);
+}
+
+/**
+ * reportErrno - Report a failed call as "message: strerror(errno)" through reportError()
+ */
+void reportErrno(const char *message) {
+    reportError("%s: %s\n", message, strerror(errno));
+}
+
+static struct FrameBuffer frameBuffer;
+
+/**
+ * emit - printf() for display output
+ *
+ * While a frame is being composed the text is appended to it (growing
+ * the buffer as needed); otherwise it is printed to stdout.
+ */
+void emit(const char *fmt, ...) {
+    va_list args;
+    
+    if (!frameBuffer.active) {
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+        return;
+    }
+    
+    for (;;) {
+        size_t room = frameBuffer.cap - frameBuffer.len;
+        va_start(args, fmt);
+        int n = vsnprintf(frameBuffer.data + frameBuffer.len, room, fmt, args);
+        va_end(args);
+        if (n < 0) {
+            return;
+        }
+        if ((size_t)n < room) {
+            frameBuffer.len += (size_t)n;
+            return;
+        }
+        
+        size_t cap = frameBuffer.cap ? frameBuffer.cap * 2 : 4096;
+        while (cap < frameBuffer.len + (size_t)n + 1) {
+            cap *= 2;
+        }
+        char *grown = realloc(frameBuffer.data, cap);
+        if (grown == NULL) {
+            return; // Drop the text rather than the frame
+        }
+        frameBuffer.data = grown;
+        frameBuffer.cap = cap;
+    }
+}
+
+static struct FrameStats frameStats;
+
+/**
+ * monotonicMicros - CLOCK_MONOTONIC time in microseconds
+ */
+double monotonicMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * stopFormatTimer - Add the time since start (from monotonicMicros()) to the frame's formatting time
+ */
+void stopFormatTimer(double start) {
+    frameStats.format_us += monotonicMicros() - start;
+}
+
+/**
+ * emitText - Append raw bytes to the frame, or write them to stdout
+ */
+void emitText(const char *text, size_t len) {
+    if (!frameBuffer.active) {
+        fwrite(text, 1, len, stdout);
+        return;
+    }
+    if (frameBuffer.len + len + 1 > frameBuffer.cap) {
+        size_t cap = frameBuffer.cap ? frameBuffer.cap * 2 : 4096;
+        while (cap < frameBuffer.len + len + 1) {
+            cap *= 2;
+        }
+        char *grown = realloc(frameBuffer.data, cap);
+        if (grown == NULL) {
+            return;
+        }
+        frameBuffer.data = grown;
+        frameBuffer.cap = cap;
+    }
+    memcpy(frameBuffer.data + frameBuffer.len, text, len);
+    frameBuffer.len += len;
+}
+
+/**
+ * emitString - Emit a NUL-terminated string as-is
+ */
+void emitString(const char *str) {
+    emitText(str, strlen(str));
+}
+
+/**
+ * utf8Prefix - Cut text to at most max bytes without splitting a UTF-8 character
+ * Returns: Bytes to keep
+ */
+static size_t utf8Prefix(const char *text, size_t len, size_t max) {
+    if (len <= max) {
+        return len;
+    }
+    // A continuation byte right after the cut means the last character
+    // straddles it; drop that character (at most 3 bytes back)
+    size_t n = max;
+    while (n > 0 && max - n < 3 && ((unsigned char)text[n] & 0xc0) == 0x80) {
+        n--;
+    }
+    return n;
+}
+
+/**
+ * emitClipped - Emit a string like "%.*s", but never ending inside a UTF-8 character
+ */
+void emitClipped(const char *str, size_t max) {
+    emitText(str, utf8Prefix(str, strnlen(str, max + 1), max));
+}
+
+/**
+ * emitAligned - Emit len bytes padded with spaces to |width| (left-aligned if width < 0)
+ */
+static void emitAligned(const char *text, size_t len, int width) {
+    static const char spaces[] = "                                                                ";
+    size_t pad = (size_t)(width < 0 ? -width : width);
+    pad = pad > len ? pad - len : 0;
+    
+    if (width < 0) {
+        emitText(text, len);
+    }
+    while (pad > 0) {
+        size_t n = pad < sizeof(spaces) - 1 ? pad : sizeof(spaces) - 1;
+        emitText(spaces, n);
+        pad -= n;
+    }
+    if (width >= 0) {
+        emitText(text, len);
+    }
+}
+
+/**
+ * emitPadded - Emit a string like "%*s" (width > 0) or "%-*.*s" (width < 0, truncated to -width
+ *              bytes on a UTF-8 character boundary)
+ */
+void emitPadded(const char *str, int width) {
+    size_t len = strlen(str);
+    if (width < 0) {
+        len = utf8Prefix(str, len, (size_t)-width);
+    }
+    emitAligned(str, len, width);
+}
+
+/**
+ * formatUnsigned - Write the decimal digits of value to out (no NUL)
+ * Returns: Number of digits (1-20)
+ */
+static inline int formatUnsigned(char *out, unsigned long long value) {
+    char digits[20];
+    int n = 0;
+    
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    for (int i = 0; i < n; i++) {
+        out[i] = digits[n - 1 - i];
+    }
+    return n;
+}
+
+/**
+ * emitUnsigned - Emit an integer like "%*llu"
+ */
+void emitUnsigned(unsigned long long value, int width) {
+    char buf[20];
+    emitAligned(buf, (size_t)formatUnsigned(buf, value), width);
+}
+
+/**
+ * emitSigned - Emit an integer like "%*lld"
+ */
+void emitSigned(long long value, int width) {
+    char buf[21];
+    int n = 0;
+    if (value < 0) {
+        buf[n++] = '-';
+    }
+    n += formatUnsigned(buf + n, value < 0 ? 0 - (unsigned long long)value : (unsigned long long)value);
+    emitAligned(buf, (size_t)n, width);
+}
+
+/**
+ * emitFixed - Emit a number like "%*.*f" with 0-6 decimals
+ *
+ * Works on a scaled integer, so ties round half away from zero (printf
+ * rounds the exact binary value instead; the last digit can differ on
+ * values like 0.125). Values too large to scale and NaN/inf go through
+ * snprintf.
+ */
+void emitFixed(double value, int decimals, int width) {
+    static const double scales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    char buf[48];
+    int n = 0;
+    
+    if (decimals < 0 || decimals > 6 || !(value > -1e12 && value < 1e12)) {
+        n = snprintf(buf, sizeof(buf), "%.*f", decimals < 0 ? 0 : decimals, value);
+        emitAligned(buf, (size_t)(n < (int)sizeof(buf) ? n : (int)sizeof(buf) - 1), width);
+        return;
+    }
+    
+    int negative = value < 0;
+    unsigned long long scaled = (unsigned long long)((negative ? -value : value) * scales[decimals] + 0.5);
+    unsigned long long unit = (unsigned long long)scales[decimals];
+    if (negative && scaled != 0) {
+        buf[n++] = '-'; // printf prints "-0.0" for tiny negatives; a display does not need it
+    }
+    n += formatUnsigned(buf + n, scaled / unit);
+    if (decimals > 0) {
+        unsigned long long fraction = scaled % unit;
+        buf[n++] = '.';
+        for (int i = decimals - 1; i >= 0; i--) {
+            buf[n + i] = (char)('0' + fraction % 10);
+            fraction /= 10;
+        }
+        n += decimals;
+    }
+    emitAligned(buf, (size_t)n, width);
+}
+
+/**
+ * readProcSource - Re-read a persistent /proc file with pread() at offset 0
+ * @src: Source handle; opened on first use and reopened if a read fails
+ * Returns: Number of bytes in src->buf (NUL-terminated), or -1 on error
+ *
+ * The buffer is doubled and the read retried whenever a read fills it,
+ * so the whole file is always returned in one piece.
+ */
+ssize_t readProcSource(struct ProcSource *src) {
+    int reopened = 0;
+    
+    if (src->buf == NULL) {
+        src->buf = malloc(PROC_SOURCE_MIN_BUF);
+        if (src->buf == NULL) {
+            return -1;
+        }
+        src->cap = PROC_SOURCE_MIN_BUF;
+    }
+    
+    for (;;) {
+        if (src->fd == -1) {
+            src->fd = open(src->path, O_RDONLY | O_CLOEXEC);
+            if (src->fd == -1) {
+                return -1;
+            }
+            reopened = 1;
+        }
+        
+        ssize_t bytes_read = pread(src->fd, src->buf, src->cap - 1, 0);
+        if (bytes_read == -1) {
+            close(src->fd);
+            src->fd = -1;
+            if (reopened) {
+                return -1; // Fresh descriptor failed too, give up
+            }
+            continue;
+        }
         
-        if (logFile != NULL) {
-            fclose(logFile);
+        if ((size_t)bytes_read == src->cap - 1) {
+            char *grown = realloc(src->buf, src->cap * 2);
+            if (grown == NULL) {
+                return -1;
+            }
+            src->buf = grown;
+            src->cap *= 2;
+            continue;
         }
         
-        exit(0);
+        src->buf[bytes_read] = '\0';
+        return bytes_read;
+    }
+}
+
+/**
+ * closeProcSource - Close descriptor and release buffer of a /proc source
+ */
+void closeProcSource(struct ProcSource *src) {
+    if (src->fd != -1) {
+        close(src->fd);
+        src->fd = -1;
+    }
+    free(src->buf);
+    src->buf = NULL;
+    src->cap = 0;
+}
+
+/**
+ * sanitizeText - Replace control bytes (below 0x20 and DEL) with '?', as ps and top do
+ *
+ * Process names, command lines and cgroup paths are chosen by whoever
+ * runs the process; printed raw, a newline breaks the table and an ESC
+ * sequence is interpreted by the terminal of whoever runs the monitor.
+ */
+void sanitizeText(char *text, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c < 0x20 || c == 0x7f) {
+            text[i] = '?';
+        }
+    }
+}
+
+/**
+ * initCursor - Point a cursor at len bytes of buf
+ */
+static inline void initCursor(struct ProcCursor *cur, const char *buf, size_t len) {
+    cur->p = buf;
+    cur->end = buf + len;
+}
+
+/**
+ * skipBlanks - Advance past spaces and tabs (not newlines)
+ */
+static inline void skipBlanks(struct ProcCursor *cur) {
+    while (cur->p < cur->end && (*cur->p == ' ' || *cur->p == '\t')) {
+        cur->p++;
+    }
+}
+
+/**
+ * skipLine - Advance to the start of the next line
+ * Returns: 1 if a next line exists, 0 at the end of the buffer
+ */
+static inline int skipLine(struct ProcCursor *cur) {
+    const char *nl = memchr(cur->p, '\n', (size_t)(cur->end - cur->p));
+    cur->p = nl ? nl + 1 : cur->end;
+    return cur->p < cur->end;
+}
+
+/**
+ * matchPrefix - Consume a literal if the cursor starts with it
+ * Returns: 1 if it matched (and was consumed), 0 otherwise
+ */
+static inline int matchPrefix(struct ProcCursor *cur, const char *lit, size_t len) {
+    if ((size_t)(cur->end - cur->p) < len || memcmp(cur->p, lit, len) != 0) {
+        return 0;
+    }
+    cur->p += len;
+    return 1;
+}
+
+/**
+ * parseUnsigned - Parse a decimal unsigned number after optional blanks
+ * Returns: 0 on success, -1 if there is no digit or the value overflows
+ *
+ * On failure the cursor is left where it was.
+ */
+static inline int parseUnsigned(struct ProcCursor *cur, unsigned long long *value) {
+    const char *p = cur->p;
+    unsigned long long v = 0;
+    
+    while (p < cur->end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    const char *start = p;
+    while (p < cur->end && *p == '0') {
+        p++;
+    }
+    const char *digits = p;
+    while (p < cur->end && (unsigned char)(*p - '0') <= 9) {
+        v = v * 10 + (unsigned long long)(*p - '0');
+        p++;
+    }
+    if (p == start) {
+        return -1;
+    }
+    // Up to 19 significant digits always fit; only 20 can overflow
+    if (p - digits >= 20 && (p - digits > 20 || memcmp(digits, "18446744073709551615", 20) > 0)) {
+        return -1;
+    }
+    *value = v;
+    cur->p = p;
+    return 0;
+}
+
+/**
+ * parseSigned - Parse an optionally negative decimal number after optional blanks
+ * Returns: 0 on success, -1 if there is no digit or the value is out of range
+ *
+ * The value is returned two's complement in an unsigned long long, so
+ * callers that store signed and unsigned fields together need no casts.
+ */
+static inline int parseSigned(struct ProcCursor *cur, unsigned long long *value) {
+    struct ProcCursor at = *cur;
+    unsigned long long magnitude;
+    
+    skipBlanks(&at);
+    int negative = matchPrefix(&at, "-", 1);
+    if (parseUnsigned(&at, &magnitude) != 0 ||
+        magnitude > (unsigned long long)INT64_MAX + (unsigned long long)negative) {
+        return -1;
+    }
+    *value = negative ? 0 - magnitude : magnitude;
+    *cur = at;
+    return 0;
+}
+
+/**
+ * parseDecimal - Parse a non-negative fixed-point number ("12.34") after optional blanks
+ * Returns: 0 on success, -1 if there is no integer part
+ *
+ * Meant for the two-decimal values the kernel prints (PSI averages,
+ * load averages); fraction digits past the 19th are ignored.
+ */
+static inline int parseDecimal(struct ProcCursor *cur, double *value) {
+    struct ProcCursor at = *cur;
+    unsigned long long whole, fraction = 0, scale = 1;
+    
+    if (parseUnsigned(&at, &whole) != 0) {
+        return -1;
+    }
+    if (matchPrefix(&at, ".", 1)) {
+        while (at.p < at.end && (unsigned char)(*at.p - '0') <= 9) {
+            if (scale < 10000000000000000000ULL) {
+                fraction = fraction * 10 + (unsigned long long)(*at.p - '0');
+                scale *= 10;
+            }
+            at.p++;
+        }
+    }
+    *value = (double)whole + (double)fraction / (double)scale;
+    *cur = at;
+    return 0;
+}
+
+/**
+ * topKBelow - Ordering used by the top-K heap (a ranks below b)
+ */
+static inline int topKBelow(const struct TopKEntry *a, const struct TopKEntry *b) {
+    return a->key < b->key || (a->key == b->key && a->tie < b->tie);
+}
+
+/**
+ * siftDownTopK - Restore the min-heap property from position i downwards
+ */
+static void siftDownTopK(struct TopKEntry *heap, int size, int i) {
+    for (;;) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < size && topKBelow(&heap[left], &heap[smallest])) smallest = left;
+        if (right < size && topKBelow(&heap[right], &heap[smallest])) smallest = right;
+        if (smallest == i) {
+            return;
+        }
+        struct TopKEntry tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+/**
+ * resetTopK - Empty a selector and set how many entries it keeps
+ * Returns: 0 on success, -1 on allocation failure
+ */
+int resetTopK(struct TopK *top, int k) {
+    if (k > top->capacity) {
+        struct TopKEntry *heap = realloc(top->heap, (size_t)k * sizeof(*heap));
+        if (heap == NULL) {
+            return -1;
+        }
+        top->heap = heap;
+        top->capacity = k;
+    }
+    top->k = k;
+    top->size = 0;
+    return 0;
+}
+
+/**
+ * offerTopK - Consider one candidate; kept only if it ranks in the top k
+ */
+void offerTopK(struct TopK *top, double key, unsigned long long tie, int id) {
+    struct TopKEntry entry = { key, tie, id };
+    
+    if (top->size < top->k) {
+        // Sift up from the new leaf
+        int i = top->size++;
+        while (i > 0 && topKBelow(&entry, &top->heap[(i - 1) / 2])) {
+            top->heap[i] = top->heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        top->heap[i] = entry;
+    } else if (top->k > 0 && topKBelow(&top->heap[0], &entry)) {
+        top->heap[0] = entry;
+        siftDownTopK(top->heap, top->size, 0);
+    }
+}
+
+/**
+ * finishTopK - Sort the kept entries in place, highest ranked first
+ * Returns: Number of entries in top->heap
+ */
+int finishTopK(struct TopK *top) {
+    // Heap sort: repeatedly move the minimum to the end of the shrinking heap
+    for (int end = top->size - 1; end > 0; end--) {
+        struct TopKEntry tmp = top->heap[0];
+        top->heap[0] = top->heap[end];
+        top->heap[end] = tmp;
+        siftDownTopK(top->heap, end, 0);
     }
+    return top->size;
+}
+
+/**
+ * freeTopK - Release selector storage
+ */
+void freeTopK(struct TopK *top) {
+    free(top->heap);
+    memset(top, 0, sizeof(*top));
+}
+
+/**
+ * handleSignal - Signal handler for graceful shutdown
+ * @sig: Signal number
+ *
+ * Only sets flags: the loops see running == 0 (poll/nanosleep/read
+ * return EINTR) and main() logs and cleans up. The handler is installed
+ * with SA_RESETHAND, so a second Ctrl+C kills a run that does not stop.
+ */
+void handleSignal(int sig) {
+    caughtSignal = sig;
+    running = 0;
 }
 
 /**
@@ -96,441 +757,5753 @@ void displayHelp() {
     printf("  ./sysmonitor              Interactive menu mode\n");
     printf("  ./sysmonitor -m cpu       Display CPU usage only\n");
     printf("  ./sysmonitor -m mem       Display memory usage only\n");
-    printf("  ./sysmonitor -m proc      List top 5 active processes\n");
-    printf("  ./sysmonitor -c <seconds> Continuous monitoring mode\n");
+    printf("  ./sysmonitor -m proc      List top active processes (5 unless -k)\n");
+    printf("  ./sysmonitor -m disk      Display disk I/O rates per device\n");
+    printf("  ./sysmonitor -m net       Display network rates per interface\n");
+    printf("  ./sysmonitor -m psi       Display CPU, memory and I/O pressure (PSI)\n");
+    printf("  ./sysmonitor -m cgroup    List top cgroups (cgroup v2) by CPU or memory\n");
+    printf("  ./sysmonitor -c <seconds> Continuous monitoring mode (fractions allowed, e.g. 0.1)\n");
     printf("  ./sysmonitor -h           Display this help message\n\n");
+    printf("Options:\n");
+    printf("  -b <name>                 Run a microbenchmark (pids, scan, stat, parse, format)\n");
+    printf("  -i <sync|uring>           Process collection backend (default sync; uring\n");
+    printf("                            falls back to sync if io_uring is unavailable)\n");
+    printf("  -k <count>                Number of processes/cgroups in the top lists (1-1000, default 5)\n");
+    printf("  -n <core|machine>         Process CPU%% per core (default) or whole machine\n");
+    printf("  -p <ms>                   PSI stall per window that wakes continuous mode\n");
+    printf("                            early (default 100, max 1000, 0 = timed only)\n");
+    printf("  -s <key>                  Rank processes by cpu (default), mem (RSS), pss,\n");
+    printf("                            minflt, majflt (faults/s), cswch or nvcswch\n");
+    printf("                            (context switches/s; reads every status file)\n");
+    printf("  -t <threads>              Process scan threads (0-1024, default 1,\n");
+    printf("                            0 = one per CPU)\n");
+    printf("  -u <modes>                CPU modes counted as busy, comma-separated\n");
+    printf("                            (user,nice,system,idle,iowait,irq,softirq,\n");
+    printf("                             steal,guest,guest_nice; default: all but idle)\n\n");
     printf("Examples:\n");
     printf("  ./sysmonitor -c 2         Monitor every 2 seconds\n");
-    printf("  ./sysmonitor -m cpu       Show CPU usage once\n\n");
+    printf("  ./sysmonitor -m cpu       Show CPU usage once\n");
+    printf("  ./sysmonitor -u user,system,steal -m cpu\n");
+    printf("                            Count only user, system and steal as busy\n\n");
 }
 
 // ==================== CPU USAGE MODULE (CONTRIBUTOR 1) ====================
 
-// Static variables to store previous CPU values for delta calculation
-static unsigned long long prev_user = 0, prev_nice = 0, prev_system = 0;
-static unsigned long long prev_idle = 0, prev_iowait = 0, prev_irq = 0, prev_softirq = 0;
-static int first_run = 1;
+// Time modes of a cpu line in /proc/stat, in file order
+enum CPUMode {
+    CPU_USER, CPU_NICE, CPU_SYSTEM, CPU_IDLE, CPU_IOWAIT,
+    CPU_IRQ, CPU_SOFTIRQ, CPU_STEAL, CPU_GUEST, CPU_GUEST_NICE,
+    CPU_FIELDS
+};
 
-/**
- * parseCPUStats - Parse CPU statistics from /proc/stat buffer
+static const char *cpuModeNames[CPU_FIELDS] = {
+    "user", "nice", "system", "idle", "iowait",
+    "irq", "softirq", "steal", "guest", "guest_nice"
+};
+
+// The kernel already counts guest time inside user and guest_nice inside
+// nice, so the guest modes are reported but never added to the total.
+#define CPU_TOTAL_FIELDS CPU_GUEST
+
+// Modes counted as "busy"; default matches 100% - idle
+#define CPU_MODE_BIT(m) (1u << (m))
+#define CPU_DEFAULT_BUSY_MASK (CPU_MODE_BIT(CPU_USER) | CPU_MODE_BIT(CPU_NICE) | \
+                               CPU_MODE_BIT(CPU_SYSTEM) | CPU_MODE_BIT(CPU_IOWAIT) | \
+                               CPU_MODE_BIT(CPU_IRQ) | CPU_MODE_BIT(CPU_SOFTIRQ) | \
+                               CPU_MODE_BIT(CPU_STEAL))
+
+static unsigned int cpuBusyMask = CPU_DEFAULT_BUSY_MASK;
+
+// System-wide lines after the cpu lines of /proc/stat (same read)
+enum StatCounter {
+    STAT_INTR,          // Interrupts serviced (first number of "intr")
+    STAT_CTXT,          // Context switches
+    STAT_PROCESSES,     // Forks since boot
+    STAT_SOFTIRQ,       // Softirqs serviced (first number of "softirq")
+    STAT_PROCS_RUNNING, // Gauge: runnable tasks
+    STAT_PROCS_BLOCKED, // Gauge: tasks blocked on I/O
+    STAT_COUNTERS
+};
+
+// Counters before this one are cumulative and reported as rates
+#define STAT_CUMULATIVE STAT_PROCS_RUNNING
+
+static const struct { const char *key; size_t len; } statCounterKeys[STAT_COUNTERS] = {
+    { "intr", 4 }, { "ctxt", 4 }, { "processes", 9 }, { "softirq", 7 },
+    { "procs_running", 13 }, { "procs_blocked", 13 }
+};
+
+/*
+ * Per-core counter table. Row 0 holds the aggregate "cpu" line and row
+ * N + 1 holds "cpuN". Counters of all rows live in one contiguous array
+ * (rows * CPU_FIELDS) so deltas are computed in a single flat loop.
  */
-int parseCPUStats(const char *buffer, unsigned long long *user, unsigned long long *nice,
-                  unsigned long long *system, unsigned long long *idle, unsigned long long *iowait,
-                  unsigned long long *irq, unsigned long long *softirq) {
-    
-    const char *line = strstr(buffer, "cpu ");
-    if (!line) {
-        fprintf(stderr, "Error: Could not find 'cpu' line in /proc/stat\n");
-        return -1;
-    }
-    
-    int parsed = sscanf(line, "cpu %llu %llu %llu %llu %llu %llu %llu",
-                        user, nice, system, idle, iowait, irq, softirq);
-    
-    if (parsed < 7) {
-        fprintf(stderr, "Error: Failed to parse CPU statistics (parsed %d fields)\n", parsed);
-        return -1;
+struct CPUCounters {
+    int rows;                   // Allocated rows (aggregate + highest CPU id + 1)
+    unsigned long long *curr;
+    unsigned long long *prev;
+    unsigned long long *delta;
+    unsigned char *online;      // Row present in the latest sample
+    unsigned char *valid;       // Row delta covers a full interval
+    unsigned char *has_prev;    // Row has a baseline for the next delta
+    unsigned long long stat[STAT_COUNTERS];         // System-wide counters and gauges
+    unsigned long long stat_prev[STAT_COUNTERS];
+    unsigned long long stat_delta[STAT_COUNTERS];
+    unsigned int stat_present;  // STAT_* lines found in the latest sample
+    unsigned int stat_valid;    // STAT_* counters whose delta covers a full interval
+    unsigned int stat_has_prev; // STAT_* counters with a baseline for the next delta
+};
+
+// Highest cpuN accepted from /proc/stat, well above the kernel's NR_CPUS
+// limit; a larger id is treated as a malformed line rather than sizing
+// the table for it
+#define CPU_ID_MAX ((1 << 16) - 1)
+
+/*
+ * Sampler context: one per consumer (display, logger, exporter...), each
+ * with its own baseline so consumers sampling at different cadences never
+ * disturb each other's intervals. All samplers share the /proc/stat handle.
+ */
+struct CPUSampler {
+    struct CPUCounters counters;
+    int cpus;                   // Online CPUs in the latest sample
+    struct timespec taken;      // CLOCK_MONOTONIC time of the latest sample
+    double elapsed;             // Seconds covered by the current deltas
+};
+
+static struct ProcSource statSource = PROC_SOURCE_INIT("/proc/stat");
+static struct ProcSource loadavgSource = PROC_SOURCE_INIT("/proc/loadavg");
+
+// Contents of /proc/loadavg
+struct LoadAverage {
+    double avg[3];                  // 1, 5 and 15 minute load averages
+    unsigned long long runnable;    // Currently runnable scheduling entities
+    unsigned long long threads;     // Scheduling entities that exist
+};
+
+// Sampler behind getCPUUsage(), created on first use
+static struct CPUSampler *displaySampler = NULL;
+
+/**
+ * parseBusyModes - Select which CPU modes count as busy
+ * @list: Comma-separated mode names, e.g. "user,system,steal"
+ * Returns: 0 on success, -1 if a name is unknown (mask left unchanged)
+ */
+int parseBusyModes(const char *list) {
+    unsigned int mask = 0;
+    const char *p = list;
+    
+    while (*p != '\0') {
+        size_t len = strcspn(p, ",");
+        int mode;
+        for (mode = 0; mode < CPU_FIELDS; mode++) {
+            if (strlen(cpuModeNames[mode]) == len && strncmp(p, cpuModeNames[mode], len) == 0) {
+                break;
+            }
+        }
+        if (mode == CPU_FIELDS) {
+            return -1;
+        }
+        mask |= CPU_MODE_BIT(mode);
+        
+        p += len;
+        if (*p == ',') {
+            p++;
+        }
+    }
+    
+    if (mask == 0) {
+        return -1;
+    }
+    cpuBusyMask = mask;
+    return 0;
+}
+
+/**
+ * growCPUCounters - Make room for at least @rows rows, zeroing new rows
+ * Returns: 0 on success, -1 on allocation failure
+ */
+int growCPUCounters(struct CPUCounters *c, int rows) {
+    if (rows <= c->rows) {
+        return 0;
+    }
+    
+    int new_rows = c->rows ? c->rows : 8;
+    while (new_rows < rows) {
+        new_rows *= 2;
+    }
+    
+    size_t old_n = (size_t)c->rows * CPU_FIELDS;
+    size_t new_n = (size_t)new_rows * CPU_FIELDS;
+    unsigned long long *curr = realloc(c->curr, new_n * sizeof(*curr));
+    if (curr == NULL) return -1;
+    c->curr = curr;
+    unsigned long long *prev = realloc(c->prev, new_n * sizeof(*prev));
+    if (prev == NULL) return -1;
+    c->prev = prev;
+    unsigned long long *delta = realloc(c->delta, new_n * sizeof(*delta));
+    if (delta == NULL) return -1;
+    c->delta = delta;
+    unsigned char *online = realloc(c->online, new_rows);
+    if (online == NULL) return -1;
+    c->online = online;
+    unsigned char *valid = realloc(c->valid, new_rows);
+    if (valid == NULL) return -1;
+    c->valid = valid;
+    unsigned char *has_prev = realloc(c->has_prev, new_rows);
+    if (has_prev == NULL) return -1;
+    c->has_prev = has_prev;
+    
+    memset(c->curr + old_n, 0, (new_n - old_n) * sizeof(*curr));
+    memset(c->prev + old_n, 0, (new_n - old_n) * sizeof(*prev));
+    memset(c->delta + old_n, 0, (new_n - old_n) * sizeof(*delta));
+    memset(c->online + c->rows, 0, new_rows - c->rows);
+    memset(c->valid + c->rows, 0, new_rows - c->rows);
+    memset(c->has_prev + c->rows, 0, new_rows - c->rows);
+    c->rows = new_rows;
+    return 0;
+}
+
+/**
+ * freeCPUCounters - Release the per-core counter table
+ */
+void freeCPUCounters(struct CPUCounters *c) {
+    free(c->curr);
+    free(c->prev);
+    free(c->delta);
+    free(c->online);
+    free(c->valid);
+    free(c->has_prev);
+    memset(c, 0, sizeof(*c));
+}
+
+/**
+ * parseCPUStats - Parse the aggregate, every cpuN line and the system-wide counters from /proc/stat
+ * @buffer: Full contents of /proc/stat (len bytes)
+ * @c: Counter table; rows of CPUs missing from this sample are marked offline
+ * Returns: Number of online CPUs found, or -1 on error
+ */
+int parseCPUStats(const char *buffer, size_t len, struct CPUCounters *c) {
+    int cpus = 0;
+    int found_total = 0;
+    
+    for (int row = 0; row < c->rows; row++) {
+        c->online[row] = 0;
+    }
+    
+    struct ProcCursor cur;
+    initCursor(&cur, buffer, len);
+    while (matchPrefix(&cur, "cpu", 3)) {
+        int row = 0;
+        
+        if (cur.p < cur.end && *cur.p != ' ') {
+            unsigned long long id;
+            if (parseUnsigned(&cur, &id) != 0 || id > CPU_ID_MAX) {
+                reportError("Error: Malformed cpu line in /proc/stat\n");
+                return -1;
+            }
+            row = (int)id + 1;
+        }
+        
+        if (growCPUCounters(c, row + 1) != 0) {
+            reportError("Error: Out of memory for %d CPUs\n", row);
+            return -1;
+        }
+        
+        // Older kernels omit the trailing steal/guest columns; they stay 0
+        unsigned long long *v = c->curr + (size_t)row * CPU_FIELDS;
+        memset(v, 0, CPU_FIELDS * sizeof(*v));
+        int parsed = 0;
+        while (parsed < CPU_FIELDS && parseUnsigned(&cur, &v[parsed]) == 0) {
+            parsed++;
+        }
+        if (parsed < CPU_SOFTIRQ + 1) {
+            reportError("Error: Failed to parse CPU statistics (parsed %d fields)\n", parsed);
+            return -1;
+        }
+        
+        c->online[row] = 1;
+        if (row == 0) {
+            found_total = 1;
+        } else {
+            cpus++;
+        }
+        
+        skipLine(&cur);
+    }
+    
+    if (!found_total) {
+        reportError("Error: Could not find 'cpu' line in /proc/stat\n");
+        return -1;
+    }
+    
+    // ctxt, processes, procs_* and the first numbers of intr and softirq
+    c->stat_present = 0;
+    while (cur.p < cur.end) {
+        for (int s = 0; s < STAT_COUNTERS; s++) {
+            if (matchPrefix(&cur, statCounterKeys[s].key, statCounterKeys[s].len)) {
+                if (cur.p < cur.end && *cur.p == ' ' && parseUnsigned(&cur, &c->stat[s]) == 0) {
+                    c->stat_present |= 1u << s;
+                }
+                break;
+            }
+        }
+        skipLine(&cur);
+    }
+    
+    return cpus;
+}
+
+/**
+ * updateCPUDeltas - Compute deltas for all rows and roll curr into prev
+ *
+ * A row's delta is only valid if the CPU was online in both samples, so a
+ * CPU that was just hotplugged starts from a fresh baseline and a CPU
+ * that went offline drops out until it returns.
+ */
+void updateCPUDeltas(struct CPUCounters *c) {
+    size_t n = (size_t)c->rows * CPU_FIELDS;
+    unsigned long long *restrict delta = c->delta;
+    const unsigned long long *restrict curr = c->curr;
+    const unsigned long long *restrict prev = c->prev;
+    
+    for (size_t i = 0; i < n; i++) {
+        delta[i] = curr[i] - prev[i];
+    }
+    
+    memcpy(c->prev, c->curr, n * sizeof(*c->prev));
+    for (int row = 0; row < c->rows; row++) {
+        c->valid[row] = c->has_prev[row] && c->online[row];
+        c->has_prev[row] = c->online[row];
+    }
+    
+    for (int s = 0; s < STAT_CUMULATIVE; s++) {
+        c->stat_delta[s] = c->stat[s] - c->stat_prev[s];
+    }
+    memcpy(c->stat_prev, c->stat, sizeof(c->stat_prev));
+    c->stat_valid = c->stat_has_prev & c->stat_present & ((1u << STAT_CUMULATIVE) - 1);
+    c->stat_has_prev = c->stat_present;
+}
+
+/**
+ * calculateCPUUsage - Calculate busy percentage from one row of deltas
+ *
+ * Busy time is the sum of the modes selected in cpuBusyMask; total time
+ * is user through steal (guest modes are already inside user and nice).
+ */
+double calculateCPUUsage(const unsigned long long *delta) {
+    unsigned long long total_delta = 0;
+    unsigned long long busy_delta = 0;
+    for (int i = 0; i < CPU_FIELDS; i++) {
+        if (i < CPU_TOTAL_FIELDS) {
+            total_delta += delta[i];
+        }
+        if (cpuBusyMask & CPU_MODE_BIT(i)) {
+            busy_delta += delta[i];
+        }
+    }
+    
+    if (total_delta == 0) {
+        return 0.0;
+    }
+    
+    return 100.0 * (double)busy_delta / (double)total_delta;
+}
+
+/**
+ * calculateCPUModes - Convert one row of deltas to per-mode percentages
+ * @percent: Output array of CPU_FIELDS percentages of the interval
+ */
+void calculateCPUModes(const unsigned long long *delta, double *percent) {
+    unsigned long long total_delta = 0;
+    for (int i = 0; i < CPU_TOTAL_FIELDS; i++) {
+        total_delta += delta[i];
+    }
+    
+    for (int i = 0; i < CPU_FIELDS; i++) {
+        percent[i] = total_delta ? 100.0 * (double)delta[i] / (double)total_delta : 0.0;
+    }
+}
+
+/**
+ * createCPUSampler - Allocate a sampler context with no baseline yet
+ * Returns: New context, or NULL on allocation failure
+ */
+struct CPUSampler *createCPUSampler() {
+    return calloc(1, sizeof(struct CPUSampler));
+}
+
+/**
+ * sampleCPU - Take a sample and update the context's deltas
+ * Returns: 0 on success, -1 on read or parse error
+ *
+ * The first sample only records a baseline; getCPUDelta() returns NULL
+ * until a second sample has been taken.
+ */
+int sampleCPU(struct CPUSampler *sampler) {
+    ssize_t len = readProcSource(&statSource);
+    if (len == -1) {
+        reportErrno("Error: Failed to read /proc/stat");
+        return -1;
+    }
+    
+    int cpus = parseCPUStats(statSource.buf, (size_t)len, &sampler->counters);
+    if (cpus < 0) {
+        return -1;
+    }
+    
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    sampler->elapsed = (now.tv_sec - sampler->taken.tv_sec) +
+                       (now.tv_nsec - sampler->taken.tv_nsec) / 1e9;
+    sampler->taken = now;
+    sampler->cpus = cpus;
+    
+    updateCPUDeltas(&sampler->counters);
+    return 0;
+}
+
+/**
+ * getCPUDelta - Counter deltas of the last interval for one CPU
+ * @cpu: CPU id, or -1 for the aggregate of all CPUs
+ * Returns: Array of CPU_FIELDS deltas, or NULL if the CPU has no full interval
+ */
+const unsigned long long *getCPUDelta(const struct CPUSampler *sampler, int cpu) {
+    const struct CPUCounters *c = &sampler->counters;
+    int row = cpu + 1;
+    
+    if (row < 0 || row >= c->rows || !c->valid[row]) {
+        return NULL;
+    }
+    return c->delta + (size_t)row * CPU_FIELDS;
+}
+
+/**
+ * getStatRate - Per-second rate of a cumulative /proc/stat counter over the last interval
+ * Returns: Rate, or -1.0 if the counter has no full interval
+ */
+double getStatRate(const struct CPUSampler *sampler, enum StatCounter counter) {
+    const struct CPUCounters *c = &sampler->counters;
+    
+    if (!((c->stat_valid >> counter) & 1u) || sampler->elapsed <= 0) {
+        return -1.0;
+    }
+    return c->stat_delta[counter] / sampler->elapsed;
+}
+
+/**
+ * parseLoadAverage - Parse /proc/loadavg ("0.13 0.07 0.09 2/73 23482")
+ * Returns: 0 on success, -1 on malformed input
+ */
+int parseLoadAverage(const char *buffer, size_t len, struct LoadAverage *load) {
+    struct ProcCursor cur;
+    
+    initCursor(&cur, buffer, len);
+    for (int i = 0; i < 3; i++) {
+        if (parseDecimal(&cur, &load->avg[i]) != 0) {
+            return -1;
+        }
+    }
+    if (parseUnsigned(&cur, &load->runnable) != 0 || !matchPrefix(&cur, "/", 1) ||
+        parseUnsigned(&cur, &load->threads) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * readLoadAverage - Re-read /proc/loadavg through its persistent descriptor
+ * Returns: 0 on success, -1 on read or parse error
+ */
+int readLoadAverage(struct LoadAverage *load) {
+    ssize_t len = readProcSource(&loadavgSource);
+    if (len == -1) {
+        return -1;
+    }
+    return parseLoadAverage(loadavgSource.buf, (size_t)len, load);
+}
+
+/**
+ * destroyCPUSampler - Release a sampler context
+ */
+void destroyCPUSampler(struct CPUSampler *sampler) {
+    if (sampler == NULL) {
+        return;
+    }
+    freeCPUCounters(&sampler->counters);
+    free(sampler);
+}
+
+/**
+ * getCPUUsage - Read CPU statistics and display aggregate and per-core usage
+ */
+void getCPUUsage() {
+    if (displaySampler == NULL) {
+        displaySampler = createCPUSampler();
+        if (displaySampler == NULL) {
+            reportError("Error: Out of memory for CPU sampler\n");
+            return;
+        }
+    }
+    
+    if (sampleCPU(displaySampler) != 0) {
+        return; // sampleCPU() reported the error
+    }
+    
+    const struct CPUCounters *c = &displaySampler->counters;
+    int cpus = displaySampler->cpus;
+    const unsigned long long *total = getCPUDelta(displaySampler, -1);
+    
+    if (total == NULL) {
+        emit("\n=== CPU Usage ===\n");
+        emit("Initializing CPU monitoring...\n");
+        emit("Run again to see CPU usage.\n\n");
+        writeLog("CPU monitoring initialized");
+        return;
+    }
+    
+    double cpu_usage = calculateCPUUsage(total);
+    double modes[CPU_FIELDS];
+    calculateCPUModes(total, modes);
+    
+    // Scheduler activity comes from the same /proc/stat read
+    double ctxt = getStatRate(displaySampler, STAT_CTXT);
+    double intr = getStatRate(displaySampler, STAT_INTR);
+    double softirq = getStatRate(displaySampler, STAT_SOFTIRQ);
+    double forks = getStatRate(displaySampler, STAT_PROCESSES);
+    struct LoadAverage load;
+    int has_load = readLoadAverage(&load) == 0;
+    
+    double format_start = monotonicMicros();
+    emitString("\n=== CPU Usage ===\nCPU Usage: ");
+    emitFixed(cpu_usage, 1, 0);
+    emitString("% (");
+    emitSigned(cpus, 0);
+    emitString(" cores online)\n");
+    for (int i = 0; i < CPU_FIELDS; i++) {
+        emitString("  ");
+        emitPadded(cpuModeNames[i], -10);
+        emitText(" ", 1);
+        emitFixed(modes[i], 1, 5);
+        emitText(i % 5 == 4 ? "%\n" : "%", i % 5 == 4 ? 2 : 1);
+    }
+    
+    int busiest = -1;
+    double busiest_usage = -1.0;
+    int column = 0;
+    for (int row = 1; row < c->rows; row++) {
+        if (!c->online[row]) {
+            continue;
+        }
+        
+        const unsigned long long *core = getCPUDelta(displaySampler, row - 1);
+        emitString("  cpu");
+        emitSigned(row - 1, -4);
+        if (core == NULL) {
+            emitString("   new ");
+        } else {
+            double core_usage = calculateCPUUsage(core);
+            emitText(" ", 1);
+            emitFixed(core_usage, 1, 5);
+            emitText("%", 1);
+            if (core_usage > busiest_usage) {
+                busiest_usage = core_usage;
+                busiest = row - 1;
+            }
+        }
+        
+        if (++column % 4 == 0) {
+            emitText("\n", 1);
+        }
+    }
+    if (column % 4 != 0) {
+        emitText("\n", 1);
+    }
+    
+    emitString("Scheduler: ");
+    emitFixed(ctxt > 0 ? ctxt : 0.0, 0, 0);
+    emitString(" ctxt/s, ");
+    emitFixed(intr > 0 ? intr : 0.0, 0, 0);
+    emitString(" intr/s, ");
+    emitFixed(softirq > 0 ? softirq : 0.0, 0, 0);
+    emitString(" softirq/s, ");
+    emitFixed(forks > 0 ? forks : 0.0, 1, 0);
+    emitString(" forks/s; ");
+    emitUnsigned(c->stat[STAT_PROCS_RUNNING], 0);
+    emitString(" running, ");
+    emitUnsigned(c->stat[STAT_PROCS_BLOCKED], 0);
+    emitString(" blocked\n");
+    if (has_load) {
+        emitString("Load average: ");
+        for (int i = 0; i < 3; i++) {
+            emitFixed(load.avg[i], 2, 0);
+            emitText(" ", 1);
+        }
+        emitText("(", 1);
+        emitUnsigned(load.runnable, 0);
+        emitText("/", 1);
+        emitUnsigned(load.threads, 0);
+        emitString(" runnable)\n");
+    }
+    emitText("\n", 1);
+    stopFormatTimer(format_start);
+    
+    char log_msg[256];
+    if (busiest >= 0) {
+        snprintf(log_msg, sizeof(log_msg), "CPU Usage: %.1f%% (steal %.1f%%, busiest core cpu%d: %.1f%%)",
+                 cpu_usage, modes[CPU_STEAL], busiest, busiest_usage);
+    } else {
+        snprintf(log_msg, sizeof(log_msg), "CPU Usage: %.1f%% (steal %.1f%%)",
+                 cpu_usage, modes[CPU_STEAL]);
+    }
+    writeLog(log_msg);
+    
+    snprintf(log_msg, sizeof(log_msg), "Scheduler: %.0f ctxt/s, %.0f intr/s, %.1f forks/s, %llu running, %llu blocked, load %.2f",
+             ctxt > 0 ? ctxt : 0.0, intr > 0 ? intr : 0.0, forks > 0 ? forks : 0.0,
+             c->stat[STAT_PROCS_RUNNING], c->stat[STAT_PROCS_BLOCKED], has_load ? load.avg[0] : 0.0);
+    writeLog(log_msg);
+}
+
+// ==================== MEMORY USAGE MODULE (CONTRIBUTOR 2) ====================
+
+/*
+ * Contributor 2: Memory Usage Module
+ * Responsibility: Implement memory monitoring functionality
+ * - Reads /proc/meminfo using system calls
+ * - Calculates Total, Used, and Free memory
+ * - Displays formatted output and logs to syslog.txt
+ */
+
+static struct ProcSource meminfoSource = PROC_SOURCE_INIT("/proc/meminfo");
+
+// Values from /proc/meminfo, in kB (HugePages_* are page counts)
+struct MemInfo {
+    unsigned long long total;
+    unsigned long long free;
+    unsigned long long available;
+    unsigned long long buffers;
+    unsigned long long cached;
+    unsigned long long sreclaimable;
+    unsigned long long shmem;
+    unsigned long long swap_total;
+    unsigned long long swap_free;
+    unsigned long long dirty;
+    unsigned long long writeback;
+    unsigned long long anon_pages;
+    unsigned long long hugepages_total;
+    unsigned long long hugepages_free;
+    unsigned long long hugepages_rsvd;
+    unsigned long long hugepages_surp;
+    unsigned long long hugepage_size;
+    unsigned int present;       // Bit i set: memInfoKeys[i] was found
+};
+
+// Key lookup table: the tracked keys and where each one is stored
+struct MemInfoKey {
+    const char *key;            // Including the trailing ':'
+    unsigned char len;
+    unsigned short offset;      // offsetof(struct MemInfo, field)
+};
+
+#define MEMINFO_KEY(k, field) { k, sizeof(k) - 1, offsetof(struct MemInfo, field) }
+
+static const struct MemInfoKey memInfoKeys[] = {
+    MEMINFO_KEY("MemTotal:", total),
+    MEMINFO_KEY("MemFree:", free),
+    MEMINFO_KEY("MemAvailable:", available),
+    MEMINFO_KEY("Buffers:", buffers),
+    MEMINFO_KEY("Cached:", cached),
+    MEMINFO_KEY("SwapTotal:", swap_total),
+    MEMINFO_KEY("SwapFree:", swap_free),
+    MEMINFO_KEY("Dirty:", dirty),
+    MEMINFO_KEY("Writeback:", writeback),
+    MEMINFO_KEY("AnonPages:", anon_pages),
+    MEMINFO_KEY("Shmem:", shmem),
+    MEMINFO_KEY("SReclaimable:", sreclaimable),
+    MEMINFO_KEY("HugePages_Total:", hugepages_total),
+    MEMINFO_KEY("HugePages_Free:", hugepages_free),
+    MEMINFO_KEY("HugePages_Rsvd:", hugepages_rsvd),
+    MEMINFO_KEY("HugePages_Surp:", hugepages_surp),
+    MEMINFO_KEY("Hugepagesize:", hugepage_size),
+};
+
+#define MEMINFO_KEYS ((int)(sizeof(memInfoKeys) / sizeof(memInfoKeys[0])))
+#define MEMINFO_HAS(info, i) (((info)->present >> (i)) & 1u)
+
+// Indices into memInfoKeys used for validation and fallbacks
+enum { MEMINFO_TOTAL = 0, MEMINFO_AVAILABLE = 2 };
+
+/**
+ * findMemInfoKey - Look up the key at the cursor and move past its ':'
+ * Returns: Table index, or -1 if we do not track the key (or there is none)
+ */
+static int findMemInfoKey(struct ProcCursor *cur) {
+    const char *key = cur->p;
+    const char *colon = key;
+    while (colon < cur->end && *colon != ':') {
+        colon++;
+    }
+    if (colon == cur->end || colon == key) {
+        return -1;
+    }
+    size_t len = (size_t)(colon - key) + 1;
+    cur->p = colon + 1;
+    
+    // Length rejects most untracked keys before any byte comparison
+    for (int i = 0; i < MEMINFO_KEYS; i++) {
+        if (memInfoKeys[i].len == len && memcmp(key, memInfoKeys[i].key, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Where each tracked key started in the last fully scanned file (-1 if
+// absent). The kernel prints the same keys in the same order every time,
+// so later reads are parsed at these offsets. Only the main thread parses.
+static int memInfoLineOffsets[MEMINFO_KEYS];
+static unsigned int memInfoLayoutKeys;  // present mask of that scan; 0 = none yet
+
+/**
+ * scanMeminfo - Parse /proc/meminfo line by line and record the key offsets
+ */
+static void scanMeminfo(const char *buffer, size_t len, struct MemInfo *info) {
+    struct ProcCursor cur;
+    
+    memset(info, 0, sizeof(*info));
+    initCursor(&cur, buffer, len);
+    
+    while (cur.p < cur.end) {
+        // One newline search per line; the key and value are parsed inside it
+        const char *nl = memchr(cur.p, '\n', (size_t)(cur.end - cur.p));
+        struct ProcCursor line = { cur.p, nl ? nl : cur.end };
+        
+        int i = findMemInfoKey(&line);
+        if (i >= 0) {
+            unsigned long long *field = (unsigned long long *)((char *)info + memInfoKeys[i].offset);
+            if (parseUnsigned(&line, field) == 0) {
+                info->present |= 1u << i;
+                memInfoLineOffsets[i] = (int)(cur.p - buffer);
+            }
+        }
+        cur.p = nl ? nl + 1 : cur.end;
+    }
+    memInfoLayoutKeys = info->present;
+}
+
+/**
+ * parseMeminfo - Parse every field of struct MemInfo from /proc/meminfo
+ * @buffer: Full contents of /proc/meminfo (len bytes)
+ * Returns: 0 on success, -1 if MemTotal is missing
+ *
+ * Each tracked key is first looked for where it was last time (a line
+ * start holding the same key), which skips the ~40 untracked lines.
+ * Values are padded to a fixed width, so offsets only move when a value
+ * grows past it; any key not found in place falls back to a full scan.
+ */
+int parseMeminfo(const char *buffer, size_t len, struct MemInfo *info) {
+    if (memInfoLayoutKeys == 0) {
+        scanMeminfo(buffer, len, info);
+        return MEMINFO_HAS(info, MEMINFO_TOTAL) ? 0 : -1;
+    }
+    
+    memset(info, 0, sizeof(*info));
+    for (int i = 0; i < MEMINFO_KEYS; i++) {
+        if (!((memInfoLayoutKeys >> i) & 1u)) {
+            continue;
+        }
+        size_t at = (size_t)memInfoLineOffsets[i];
+        const struct MemInfoKey *k = &memInfoKeys[i];
+        struct ProcCursor line = { buffer + at + k->len, buffer + len };
+        unsigned long long *field = (unsigned long long *)((char *)info + k->offset);
+        if (at + k->len > len || (at > 0 && buffer[at - 1] != '\n') ||
+            memcmp(buffer + at, k->key, k->len) != 0 || parseUnsigned(&line, field) != 0) {
+            scanMeminfo(buffer, len, info);
+            break;
+        }
+        info->present |= 1u << i;
+    }
+    return MEMINFO_HAS(info, MEMINFO_TOTAL) ? 0 : -1;
+}
+
+/**
+ * calculateMemoryUsed - Used memory in kB, derived the way free(1) does
+ * @available: Receives the available memory in kB
+ *
+ * Page cache and reclaimable slab are not "used": Used = Total - MemAvailable.
+ * Kernels before 3.14 have no MemAvailable; there it is estimated as
+ * Free + Buffers + Cached + SReclaimable and Used is the remainder.
+ */
+unsigned long long calculateMemoryUsed(const struct MemInfo *info, unsigned long long *available) {
+    unsigned long long avail = info->available;
+    
+    if (!MEMINFO_HAS(info, MEMINFO_AVAILABLE)) {
+        avail = info->free + info->buffers + info->cached + info->sreclaimable;
+    }
+    if (avail > info->total) {
+        avail = info->total;
+    }
+    *available = avail;
+    return info->total - avail;
+}
+
+void getMemoryUsage() {
+    // 1-2. Re-read /proc/meminfo through the persistent descriptor
+    // The source stays open between samples and is reopened if a read fails;
+    // its buffer grows, so new meminfo keys never truncate the read
+    ssize_t len = readProcSource(&meminfoSource);
+    if (len == -1) {
+        reportErrno("Error reading /proc/meminfo");
+        return;
+    }
+
+    // 3. Parse every tracked field through the key table
+    struct MemInfo info;
+    if (parseMeminfo(meminfoSource.buf, (size_t)len, &info) != 0) {
+        reportError("Error: Could not find MemTotal in /proc/meminfo\n");
+        return;
+    }
+
+    // 4. Calculate Statistics (Convert kB to MB)
+    unsigned long long available_kB;
+    unsigned long long used_kB = calculateMemoryUsed(&info, &available_kB);
+    long memTotal_MB = (long)(info.total / 1024);
+    long memUsed_MB = (long)(used_kB / 1024);
+    long memFree_MB = (long)(info.free / 1024);
+    long memAvailable_MB = (long)(available_kB / 1024);
+    long bufCache_MB = (long)((info.buffers + info.cached + info.sreclaimable) / 1024);
+    long swapTotal_MB = (long)(info.swap_total / 1024);
+    long swapUsed_MB = (long)((info.swap_total > info.swap_free ? info.swap_total - info.swap_free : 0) / 1024);
+    
+    double usagePercent = 0.0;
+    if (info.total > 0) {
+        usagePercent = ((double)used_kB / info.total) * 100.0;
+    }
+
+    // 5. Display Output to Terminal
+    double format_start = monotonicMicros();
+    emitString("\n=== Memory Usage ===\nTotal Memory:  ");
+    emitSigned(memTotal_MB, 0);
+    emitString(" MB\nUsed Memory:   ");
+    emitSigned(memUsed_MB, 0);
+    emitString(MEMINFO_HAS(&info, MEMINFO_AVAILABLE) ? " MB\n" : " MB (estimated, no MemAvailable)\n");
+    emitString("Free Memory:   ");
+    emitSigned(memFree_MB, 0);
+    emitString(" MB\nAvailable:     ");
+    emitSigned(memAvailable_MB, 0);
+    emitString(" MB\nBuff/Cache:    ");
+    emitSigned(bufCache_MB, 0);
+    emitString(" MB (buffers ");
+    emitUnsigned(info.buffers / 1024, 0);
+    emitString(", cached ");
+    emitUnsigned(info.cached / 1024, 0);
+    emitString(", reclaimable slab ");
+    emitUnsigned(info.sreclaimable / 1024, 0);
+    emitString(" MB)\nShared:        ");
+    emitUnsigned(info.shmem / 1024, 0);
+    emitString(" MB\nAnonymous:     ");
+    emitUnsigned(info.anon_pages / 1024, 0);
+    emitString(" MB\nDirty:         ");
+    emitUnsigned(info.dirty, 0);
+    emitString(" kB (writeback ");
+    emitUnsigned(info.writeback, 0);
+    emitString(" kB)\n");
+    if (info.swap_total > 0) {
+        emitString("Swap:          ");
+        emitSigned(swapUsed_MB, 0);
+        emitString(" / ");
+        emitSigned(swapTotal_MB, 0);
+        emitString(" MB used\n");
+    } else {
+        emitString("Swap:          none\n");
+    }
+    if (info.hugepages_total > 0) {
+        emitString("HugePages:     ");
+        emitUnsigned(info.hugepages_free, 0);
+        emitString(" / ");
+        emitUnsigned(info.hugepages_total, 0);
+        emitString(" free (");
+        emitUnsigned(info.hugepages_rsvd, 0);
+        emitString(" reserved, ");
+        emitUnsigned(info.hugepages_surp, 0);
+        emitString(" surplus, ");
+        emitUnsigned(info.hugepage_size, 0);
+        emitString(" kB each)\n");
+    }
+    emitString("Usage:         ");
+    emitFixed(usagePercent, 1, 0);
+    emitString("%\n====================\n");
+    stopFormatTimer(format_start);
+
+    // 6. Logging
+    // Format the log string. Note: writeLog() is a shared helper from your leader.
+    char logMsg[256];
+    snprintf(logMsg, sizeof(logMsg), "Memory - Total: %ldMB, Used: %ldMB, Free: %ldMB, Available: %ldMB (%.1f%%)", 
+             memTotal_MB, memUsed_MB, memFree_MB, memAvailable_MB, usagePercent);
+    
+    writeLog(logMsg); 
+}
+
+// ==================== DISK I/O MODULE ====================
+
+/*
+ * Disk I/O Module
+ * - Re-reads /proc/diskstats through a persistent descriptor every tick
+ * - Computes per-device IOPS, throughput, await, queue depth and utilization
+ *   from counter deltas, using the same sampler pattern as the CPU module
+ * - Partitions and loop/ram devices are skipped; the check is made once per device
+ */
+
+// Counters of a /proc/diskstats line after "major minor name", in file
+// order. Newer kernels append discard and flush counters, which are ignored.
+enum DiskField {
+    DISK_READS, DISK_READS_MERGED, DISK_SECTORS_READ, DISK_READ_MS,
+    DISK_WRITES, DISK_WRITES_MERGED, DISK_SECTORS_WRITTEN, DISK_WRITE_MS,
+    DISK_IN_FLIGHT, DISK_IO_MS, DISK_WEIGHTED_MS,
+    DISK_FIELDS
+};
+
+#define DISK_SECTOR_BYTES 512       // diskstats always counts 512-byte sectors
+#define DISK_NAME_LEN 32
+
+struct DiskDevice {
+    unsigned int major;
+    unsigned int minor;
+    char name[DISK_NAME_LEN];
+    int skip;                   // Partition or loop/ram device, decided on first sight
+    int online;                 // Present in the latest sample
+    int has_prev;               // prev holds a baseline
+    int valid;                  // delta covers a full interval
+    unsigned long long curr[DISK_FIELDS];
+    unsigned long long prev[DISK_FIELDS];
+    unsigned long long delta[DISK_FIELDS];
+};
+
+// Per-consumer sampler context, like struct CPUSampler
+struct DiskSampler {
+    struct DiskDevice *devices; // In /proc/diskstats order
+    int count;
+    int capacity;
+    int primed;                 // A baseline sample has been taken
+    struct timespec taken;      // CLOCK_MONOTONIC time of the latest sample
+    double elapsed;             // Seconds covered by the current deltas
+};
+
+// Rates of one device over the last interval
+struct DiskRates {
+    double reads_per_sec;
+    double writes_per_sec;
+    double read_kb_per_sec;
+    double write_kb_per_sec;
+    double await_ms;            // Average time per completed I/O, queueing included
+    double queue_depth;         // Average requests in flight (aqu-sz)
+    double util_percent;        // Share of the interval with I/O in flight
+};
+
+static struct ProcSource diskstatsSource = PROC_SOURCE_INIT("/proc/diskstats");
+
+// Sampler behind getDiskUsage(), created on first use
+static struct DiskSampler *diskDisplaySampler = NULL;
+
+/**
+ * isSkippedDisk - Decide whether a device is left out of the disk view
+ *
+ * Decided from the device's sysfs directory, once per device:
+ * partitions ("partition" attribute) double-count their whole disk, and
+ * software devices with neither hardware behind them ("device" link)
+ * nor other disks under them ("slaves/", as dm and md have) mirror other
+ * I/O or none at all: loop, ram and zram. Without sysfs nothing is skipped.
+ */
+int isSkippedDisk(unsigned int major, unsigned int minor) {
+    char path[64];
+    
+    snprintf(path, sizeof(path), "/sys/dev/block/%u:%u", major, minor);
+    int dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd == -1) {
+        return 0;
+    }
+    
+    int skip = faccessat(dir_fd, "partition", F_OK, 0) == 0;
+    if (!skip && faccessat(dir_fd, "device", F_OK, 0) != 0) {
+        skip = 1;
+        int slaves_fd = openat(dir_fd, "slaves", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        DIR *slaves = slaves_fd != -1 ? fdopendir(slaves_fd) : NULL;
+        if (slaves != NULL) {
+            struct dirent *entry;
+            while ((entry = readdir(slaves)) != NULL) {
+                if (entry->d_name[0] != '.') {
+                    skip = 0;
+                    break;
+                }
+            }
+            closedir(slaves);
+        } else if (slaves_fd != -1) {
+            close(slaves_fd);
+        }
+    }
+    close(dir_fd);
+    return skip;
+}
+
+/**
+ * findDiskDevice - Find or add the device entry for major:minor
+ * @hint: Index where the device was in the previous sample (lines keep their order)
+ * Returns: Device entry, or NULL on allocation failure
+ */
+struct DiskDevice *findDiskDevice(struct DiskSampler *sampler, unsigned int major, unsigned int minor,
+                                  const char *name, size_t name_len, int hint) {
+    if (hint < sampler->count && sampler->devices[hint].major == major &&
+        sampler->devices[hint].minor == minor) {
+        return &sampler->devices[hint];
+    }
+    for (int i = 0; i < sampler->count; i++) {
+        if (sampler->devices[i].major == major && sampler->devices[i].minor == minor) {
+            return &sampler->devices[i];
+        }
+    }
+    
+    if (sampler->count == sampler->capacity) {
+        int capacity = sampler->capacity ? sampler->capacity * 2 : 16;
+        struct DiskDevice *devices = realloc(sampler->devices, (size_t)capacity * sizeof(*devices));
+        if (devices == NULL) {
+            return NULL;
+        }
+        sampler->devices = devices;
+        sampler->capacity = capacity;
+    }
+    
+    struct DiskDevice *dev = &sampler->devices[sampler->count++];
+    memset(dev, 0, sizeof(*dev));
+    dev->major = major;
+    dev->minor = minor;
+    if (name_len > sizeof(dev->name) - 1) {
+        name_len = sizeof(dev->name) - 1;
+    }
+    memcpy(dev->name, name, name_len);
+    dev->skip = isSkippedDisk(major, minor);
+    return dev;
+}
+
+/**
+ * parseDiskStats - Parse /proc/diskstats into the sampler's devices
+ * @buffer: Full contents of /proc/diskstats (len bytes)
+ * Returns: Number of devices (skipped ones included), or -1 on error
+ */
+int parseDiskStats(const char *buffer, size_t len, struct DiskSampler *sampler) {
+    struct ProcCursor cur;
+    int line = 0;
+    
+    for (int i = 0; i < sampler->count; i++) {
+        sampler->devices[i].online = 0;
+    }
+    
+    initCursor(&cur, buffer, len);
+    while (cur.p < cur.end) {
+        unsigned long long major, minor;
+        if (parseUnsigned(&cur, &major) != 0 || parseUnsigned(&cur, &minor) != 0) {
+            reportError("Error: Malformed line in /proc/diskstats\n");
+            return -1;
+        }
+        skipBlanks(&cur);
+        const char *name = cur.p;
+        while (cur.p < cur.end && *cur.p != ' ' && *cur.p != '\n') {
+            cur.p++;
+        }
+        
+        struct DiskDevice *dev = findDiskDevice(sampler, (unsigned int)major, (unsigned int)minor,
+                                                name, (size_t)(cur.p - name), line);
+        if (dev == NULL) {
+            reportError("Error: Out of memory for disk devices\n");
+            return -1;
+        }
+        dev->online = 1;
+        line++;
+        
+        // Skipped devices cost only the lookup, not the counter parsing
+        if (!dev->skip) {
+            for (int f = 0; f < DISK_FIELDS; f++) {
+                if (parseUnsigned(&cur, &dev->curr[f]) != 0) {
+                    reportError("Error: Malformed counters for %s in /proc/diskstats\n", dev->name);
+                    return -1;
+                }
+            }
+        }
+        skipLine(&cur);
+    }
+    return line;
+}
+
+/**
+ * updateDiskDeltas - Compute deltas for every device and roll curr into prev
+ *
+ * A device that disappears (or whose counters go backwards because it was
+ * re-added) starts from a fresh baseline.
+ */
+void updateDiskDeltas(struct DiskSampler *sampler) {
+    for (int i = 0; i < sampler->count; i++) {
+        struct DiskDevice *dev = &sampler->devices[i];
+        int valid = dev->has_prev && dev->online && !dev->skip;
+        
+        for (int f = 0; f < DISK_FIELDS && valid; f++) {
+            // In-flight is a gauge, everything else a counter
+            if (f != DISK_IN_FLIGHT && dev->curr[f] < dev->prev[f]) {
+                valid = 0;
+            }
+            dev->delta[f] = dev->curr[f] - dev->prev[f];
+        }
+        dev->valid = valid;
+        dev->has_prev = dev->online && !dev->skip;
+        memcpy(dev->prev, dev->curr, sizeof(dev->prev));
+    }
+}
+
+struct DiskSampler *createDiskSampler() {
+    return calloc(1, sizeof(struct DiskSampler));
+}
+
+/**
+ * sampleDisks - Take a sample and update the context's deltas
+ * Returns: 0 on success, -1 on read or parse error
+ */
+int sampleDisks(struct DiskSampler *sampler) {
+    ssize_t len = readProcSource(&diskstatsSource);
+    if (len == -1) {
+        reportErrno("Error: Failed to read /proc/diskstats");
+        return -1;
+    }
+    if (parseDiskStats(diskstatsSource.buf, (size_t)len, sampler) < 0) {
+        return -1;
+    }
+    
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    sampler->elapsed = (now.tv_sec - sampler->taken.tv_sec) +
+                       (now.tv_nsec - sampler->taken.tv_nsec) / 1e9;
+    sampler->taken = now;
+    
+    updateDiskDeltas(sampler);
+    sampler->primed = 1;
+    return 0;
+}
+
+/**
+ * calculateDiskRates - Derive iostat-style rates from a device's deltas
+ * Returns: 0 on success, -1 if the device has no full interval
+ */
+int calculateDiskRates(const struct DiskSampler *sampler, const struct DiskDevice *dev, struct DiskRates *rates) {
+    if (!dev->valid || sampler->elapsed <= 0) {
+        return -1;
+    }
+    
+    const unsigned long long *d = dev->delta;
+    double seconds = sampler->elapsed;
+    double interval_ms = seconds * 1000.0;
+    unsigned long long ios = d[DISK_READS] + d[DISK_WRITES];
+    
+    rates->reads_per_sec = d[DISK_READS] / seconds;
+    rates->writes_per_sec = d[DISK_WRITES] / seconds;
+    rates->read_kb_per_sec = d[DISK_SECTORS_READ] * (DISK_SECTOR_BYTES / 1024.0) / seconds;
+    rates->write_kb_per_sec = d[DISK_SECTORS_WRITTEN] * (DISK_SECTOR_BYTES / 1024.0) / seconds;
+    rates->await_ms = ios > 0 ? (double)(d[DISK_READ_MS] + d[DISK_WRITE_MS]) / ios : 0.0;
+    rates->queue_depth = d[DISK_WEIGHTED_MS] / interval_ms;
+    rates->util_percent = d[DISK_IO_MS] * 100.0 / interval_ms;
+    if (rates->util_percent > 100.0) {
+        rates->util_percent = 100.0;
+    }
+    return 0;
+}
+
+/**
+ * destroyDiskSampler - Release a sampler context
+ */
+void destroyDiskSampler(struct DiskSampler *sampler) {
+    if (sampler == NULL) {
+        return;
+    }
+    free(sampler->devices);
+    free(sampler);
+}
+
+/**
+ * getDiskUsage - Sample /proc/diskstats and display per-device I/O rates
+ */
+void getDiskUsage() {
+    if (diskDisplaySampler == NULL) {
+        diskDisplaySampler = createDiskSampler();
+        if (diskDisplaySampler == NULL) {
+            reportError("Error: Out of memory for disk sampler\n");
+            return;
+        }
+    }
+    
+    int first = !diskDisplaySampler->primed;
+    if (sampleDisks(diskDisplaySampler) != 0) {
+        return;
+    }
+    
+    emit("\n=== Disk I/O ===\n");
+    if (first) {
+        emit("Initializing disk monitoring...\n");
+        emit("Run again to see disk I/O.\n\n");
+        writeLog("Disk monitoring initialized");
+        return;
+    }
+    
+    double format_start = monotonicMicros();
+    emit("%-12s %8s %8s %10s %10s %10s %8s %7s\n",
+           "Device", "r/s", "w/s", "rkB/s", "wkB/s", "await(ms)", "aqu-sz", "%util");
+    
+    const struct DiskDevice *busiest = NULL;
+    struct DiskRates busiest_rates = { 0 };
+    int shown = 0;
+    for (int i = 0; i < diskDisplaySampler->count; i++) {
+        const struct DiskDevice *dev = &diskDisplaySampler->devices[i];
+        struct DiskRates rates;
+        if (calculateDiskRates(diskDisplaySampler, dev, &rates) != 0) {
+            continue;
+        }
+        
+        emit("%-12.12s %8.1f %8.1f %10.1f %10.1f %10.2f %8.2f %6.1f%%\n", dev->name,
+               rates.reads_per_sec, rates.writes_per_sec, rates.read_kb_per_sec,
+               rates.write_kb_per_sec, rates.await_ms, rates.queue_depth, rates.util_percent);
+        shown++;
+        if (busiest == NULL || rates.util_percent > busiest_rates.util_percent) {
+            busiest = dev;
+            busiest_rates = rates;
+        }
+    }
+    if (shown == 0) {
+        emit("No disks found.\n");
+    }
+    emit("\n");
+    stopFormatTimer(format_start);
+    
+    if (busiest != NULL) {
+        char log_msg[256];
+        snprintf(log_msg, sizeof(log_msg), "Disk I/O: busiest %s at %.1f%% util (%.1f IOPS, await %.2f ms)",
+                 busiest->name, busiest_rates.util_percent,
+                 busiest_rates.reads_per_sec + busiest_rates.writes_per_sec, busiest_rates.await_ms);
+        writeLog(log_msg);
+    }
+}
+
+// ==================== NETWORK MODULE ====================
+
+/*
+ * Network Module
+ * - Re-reads /proc/net/dev through a persistent descriptor every tick
+ * - Computes per-interface bytes, packets, drops and errors per second
+ * - Interface names are interned in the sampler when first seen, so a
+ *   tick only compares names and never allocates
+ */
+
+// Counters of a /proc/net/dev line after "name:", in file order
+enum NetField {
+    NET_RX_BYTES, NET_RX_PACKETS, NET_RX_ERRS, NET_RX_DROP,
+    NET_RX_FIFO, NET_RX_FRAME, NET_RX_COMPRESSED, NET_RX_MULTICAST,
+    NET_TX_BYTES, NET_TX_PACKETS, NET_TX_ERRS, NET_TX_DROP,
+    NET_TX_FIFO, NET_TX_COLLS, NET_TX_CARRIER, NET_TX_COMPRESSED,
+    NET_FIELDS
+};
+
+#define NET_NAME_LEN 16             // IFNAMSIZ
+
+struct NetInterface {
+    char name[NET_NAME_LEN];    // Interned on first sight
+    unsigned char name_len;
+    int online;                 // Present in the latest sample
+    int has_prev;
+    int valid;                  // delta covers a full interval
+    unsigned long long curr[NET_FIELDS];
+    unsigned long long prev[NET_FIELDS];
+    unsigned long long delta[NET_FIELDS];
+};
+
+// Per-consumer sampler context, like struct CPUSampler
+struct NetSampler {
+    struct NetInterface *ifaces;    // In /proc/net/dev order
+    int count;
+    int capacity;
+    int primed;                     // A baseline sample has been taken
+    struct timespec taken;          // CLOCK_MONOTONIC time of the latest sample
+    double elapsed;                 // Seconds covered by the current deltas
+};
+
+static struct ProcSource netdevSource = PROC_SOURCE_INIT("/proc/net/dev");
+
+// Sampler behind getNetworkUsage(), created on first use
+static struct NetSampler *netDisplaySampler = NULL;
+
+/**
+ * findNetInterface - Find or intern the interface with this name
+ * @hint: Index where the interface was in the previous sample
+ * Returns: Interface entry, or NULL on allocation failure
+ */
+struct NetInterface *findNetInterface(struct NetSampler *sampler, const char *name, size_t len, int hint) {
+    if (len > NET_NAME_LEN - 1) {
+        len = NET_NAME_LEN - 1;
+    }
+    if (hint < sampler->count && sampler->ifaces[hint].name_len == len &&
+        memcmp(sampler->ifaces[hint].name, name, len) == 0) {
+        return &sampler->ifaces[hint];
+    }
+    for (int i = 0; i < sampler->count; i++) {
+        if (sampler->ifaces[i].name_len == len && memcmp(sampler->ifaces[i].name, name, len) == 0) {
+            return &sampler->ifaces[i];
+        }
+    }
+    
+    if (sampler->count == sampler->capacity) {
+        int capacity = sampler->capacity ? sampler->capacity * 2 : 16;
+        struct NetInterface *ifaces = realloc(sampler->ifaces, (size_t)capacity * sizeof(*ifaces));
+        if (ifaces == NULL) {
+            return NULL;
+        }
+        sampler->ifaces = ifaces;
+        sampler->capacity = capacity;
+    }
+    
+    struct NetInterface *iface = &sampler->ifaces[sampler->count++];
+    memset(iface, 0, sizeof(*iface));
+    memcpy(iface->name, name, len);
+    iface->name_len = (unsigned char)len;
+    return iface;
+}
+
+/**
+ * parseNetDev - Parse /proc/net/dev into the sampler's interfaces
+ * @buffer: Full contents of /proc/net/dev (len bytes)
+ * Returns: Number of interfaces, or -1 on error
+ */
+int parseNetDev(const char *buffer, size_t len, struct NetSampler *sampler) {
+    struct ProcCursor cur;
+    int line = 0;
+    
+    for (int i = 0; i < sampler->count; i++) {
+        sampler->ifaces[i].online = 0;
+    }
+    
+    // Skip the two header lines
+    initCursor(&cur, buffer, len);
+    skipLine(&cur);
+    skipLine(&cur);
+    
+    while (cur.p < cur.end) {
+        // "  eth0: 1234 ..." -- the name may run straight into the first number
+        skipBlanks(&cur);
+        const char *name = cur.p;
+        while (cur.p < cur.end && *cur.p != ':' && *cur.p != '\n') {
+            cur.p++;
+        }
+        if (!matchPrefix(&cur, ":", 1)) {
+            reportError("Error: Malformed line in /proc/net/dev\n");
+            return -1;
+        }
+        
+        struct NetInterface *iface = findNetInterface(sampler, name, (size_t)(cur.p - 1 - name), line);
+        if (iface == NULL) {
+            reportError("Error: Out of memory for network interfaces\n");
+            return -1;
+        }
+        for (int f = 0; f < NET_FIELDS; f++) {
+            if (parseUnsigned(&cur, &iface->curr[f]) != 0) {
+                reportError("Error: Malformed counters for %s in /proc/net/dev\n", iface->name);
+                return -1;
+            }
+        }
+        iface->online = 1;
+        line++;
+        skipLine(&cur);
+    }
+    return line;
+}
+
+/**
+ * updateNetDeltas - Compute deltas for every interface and roll curr into prev
+ *
+ * An interface that disappears, or whose counters go backwards because it
+ * was re-created, starts from a fresh baseline.
+ */
+void updateNetDeltas(struct NetSampler *sampler) {
+    for (int i = 0; i < sampler->count; i++) {
+        struct NetInterface *iface = &sampler->ifaces[i];
+        int valid = iface->has_prev && iface->online;
+        
+        for (int f = 0; f < NET_FIELDS && valid; f++) {
+            if (iface->curr[f] < iface->prev[f]) {
+                valid = 0;
+            }
+            iface->delta[f] = iface->curr[f] - iface->prev[f];
+        }
+        iface->valid = valid;
+        iface->has_prev = iface->online;
+        memcpy(iface->prev, iface->curr, sizeof(iface->prev));
+    }
+}
+
+struct NetSampler *createNetSampler() {
+    return calloc(1, sizeof(struct NetSampler));
+}
+
+/**
+ * sampleNetwork - Take a sample and update the context's deltas
+ * Returns: 0 on success, -1 on read or parse error
+ */
+int sampleNetwork(struct NetSampler *sampler) {
+    ssize_t len = readProcSource(&netdevSource);
+    if (len == -1) {
+        reportErrno("Error: Failed to read /proc/net/dev");
+        return -1;
+    }
+    if (parseNetDev(netdevSource.buf, (size_t)len, sampler) < 0) {
+        return -1;
+    }
+    
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    sampler->elapsed = (now.tv_sec - sampler->taken.tv_sec) +
+                       (now.tv_nsec - sampler->taken.tv_nsec) / 1e9;
+    sampler->taken = now;
+    
+    updateNetDeltas(sampler);
+    sampler->primed = 1;
+    return 0;
+}
+
+/**
+ * getNetRate - Per-second rate of one counter over the last interval
+ * Returns: Rate, or -1.0 if the interface has no full interval
+ */
+double getNetRate(const struct NetSampler *sampler, const struct NetInterface *iface, enum NetField field) {
+    if (!iface->valid || sampler->elapsed <= 0) {
+        return -1.0;
+    }
+    return iface->delta[field] / sampler->elapsed;
+}
+
+/**
+ * destroyNetSampler - Release a sampler context
+ */
+void destroyNetSampler(struct NetSampler *sampler) {
+    if (sampler == NULL) {
+        return;
+    }
+    free(sampler->ifaces);
+    free(sampler);
+}
+
+/**
+ * getNetworkUsage - Sample /proc/net/dev and display per-interface rates
+ */
+void getNetworkUsage() {
+    if (netDisplaySampler == NULL) {
+        netDisplaySampler = createNetSampler();
+        if (netDisplaySampler == NULL) {
+            reportError("Error: Out of memory for network sampler\n");
+            return;
+        }
+    }
+    
+    int first = !netDisplaySampler->primed;
+    if (sampleNetwork(netDisplaySampler) != 0) {
+        return;
+    }
+    
+    emit("\n=== Network ===\n");
+    if (first) {
+        emit("Initializing network monitoring...\n");
+        emit("Run again to see network rates.\n\n");
+        writeLog("Network monitoring initialized");
+        return;
+    }
+    
+    double format_start = monotonicMicros();
+    emit("%-12s %10s %10s %9s %9s %8s %8s %8s %8s\n", "Interface", "rx kB/s", "tx kB/s",
+           "rx pkt/s", "tx pkt/s", "rx drp/s", "tx drp/s", "rx err/s", "tx err/s");
+    
+    double total_rx = 0.0, total_tx = 0.0;
+    double total_drops = 0.0, total_errors = 0.0;
+    for (int i = 0; i < netDisplaySampler->count; i++) {
+        const struct NetInterface *iface = &netDisplaySampler->ifaces[i];
+        if (!iface->valid) {
+            continue;
+        }
+        
+        double rx = getNetRate(netDisplaySampler, iface, NET_RX_BYTES) / 1024.0;
+        double tx = getNetRate(netDisplaySampler, iface, NET_TX_BYTES) / 1024.0;
+        double rx_drop = getNetRate(netDisplaySampler, iface, NET_RX_DROP);
+        double tx_drop = getNetRate(netDisplaySampler, iface, NET_TX_DROP);
+        double rx_err = getNetRate(netDisplaySampler, iface, NET_RX_ERRS);
+        double tx_err = getNetRate(netDisplaySampler, iface, NET_TX_ERRS);
+        emit("%-12.12s %10.1f %10.1f %9.1f %9.1f %8.1f %8.1f %8.1f %8.1f\n", iface->name, rx, tx,
+               getNetRate(netDisplaySampler, iface, NET_RX_PACKETS),
+               getNetRate(netDisplaySampler, iface, NET_TX_PACKETS),
+               rx_drop, tx_drop, rx_err, tx_err);
+        
+        total_rx += rx;
+        total_tx += tx;
+        total_drops += rx_drop + tx_drop;
+        total_errors += rx_err + tx_err;
+    }
+    emit("\n");
+    stopFormatTimer(format_start);
+    
+    char log_msg[256];
+    snprintf(log_msg, sizeof(log_msg), "Network: rx %.1f kB/s, tx %.1f kB/s, drops %.1f/s, errors %.1f/s",
+             total_rx, total_tx, total_drops, total_errors);
+    writeLog(log_msg);
+}
+
+// ==================== PRESSURE (PSI) MODULE ====================
+
+/*
+ * Pressure Module
+ * - Reads /proc/pressure/{cpu,memory,io} for the kernel's some/full
+ *   stall averages (share of wall time tasks were stalled, in percent)
+ * - Registers a PSI trigger on each file ("some <stall> <window>") so
+ *   the kernel raises POLLPRI within milliseconds of a stall; continuous
+ *   mode poll()s the triggers instead of sleeping and redraws at once
+ * - Without trigger support (old kernel, PSI disabled) it falls back to
+ *   a plain timed sleep
+ */
+
+enum PressureResource {
+    PSI_CPU,
+    PSI_MEMORY,
+    PSI_IO,
+    PSI_RESOURCES
+};
+
+static const char *const pressureNames[PSI_RESOURCES] = { "cpu", "memory", "io" };
+
+// Index into the avg arrays, in file order
+enum PressureAverage { PSI_AVG10, PSI_AVG60, PSI_AVG300, PSI_AVERAGES };
+
+struct PressureStats {
+    double some[PSI_AVERAGES];      // % of time at least one task stalled
+    double full[PSI_AVERAGES];      // % of time all non-idle tasks stalled
+    unsigned long long some_total;  // Cumulative stall time in microseconds
+    unsigned long long full_total;
+    int has_full;                   // cpu has no "full" line before Linux 5.13
+};
+
+#define PSI_WINDOW_US 1000000           // Trigger window
+#define PSI_UNPRIV_WINDOW_US 2000000    // Without CAP_SYS_RESOURCE the window must be a multiple of 2 s
+#define PSI_DEFAULT_STALL_MS 100
+
+struct PressureTriggers {
+    int fd[PSI_RESOURCES];              // -1 when no trigger is armed
+    unsigned long fired[PSI_RESOURCES]; // Events seen since registration
+    unsigned int window_us[PSI_RESOURCES];
+    int registered;                     // registerPressureTriggers() ran
+};
+
+static struct ProcSource pressureSources[PSI_RESOURCES] = {
+    PROC_SOURCE_INIT("/proc/pressure/cpu"),
+    PROC_SOURCE_INIT("/proc/pressure/memory"),
+    PROC_SOURCE_INIT("/proc/pressure/io"),
+};
+
+static struct PressureTriggers pressureTriggers = { { -1, -1, -1 }, { 0 }, { 0 }, 0 };
+
+// Stall per window (ms) that fires a trigger, 0 to disable triggers (-p)
+static int pressureStallMs = PSI_DEFAULT_STALL_MS;
+
+/**
+ * parsePressureLine - Parse " avg10=X avg60=Y avg300=Z total=N" after "some"/"full"
+ * Returns: 0 on success, -1 on malformed input
+ */
+static int parsePressureLine(struct ProcCursor *cur, double *avg, unsigned long long *total) {
+    static const struct { const char *key; size_t len; } keys[PSI_AVERAGES] = {
+        { " avg10=", 7 }, { " avg60=", 7 }, { " avg300=", 8 }
+    };
+    
+    for (int i = 0; i < PSI_AVERAGES; i++) {
+        if (!matchPrefix(cur, keys[i].key, keys[i].len) || parseDecimal(cur, &avg[i]) != 0) {
+            return -1;
+        }
+    }
+    if (!matchPrefix(cur, " total=", 7) || parseUnsigned(cur, total) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * parsePressure - Parse the contents of a /proc/pressure file
+ * Returns: 0 on success, -1 on malformed input
+ */
+int parsePressure(const char *buffer, size_t len, struct PressureStats *stats) {
+    struct ProcCursor cur;
+    int has_some = 0;
+    
+    memset(stats, 0, sizeof(*stats));
+    initCursor(&cur, buffer, len);
+    while (cur.p < cur.end) {
+        if (matchPrefix(&cur, "some", 4)) {
+            if (parsePressureLine(&cur, stats->some, &stats->some_total) != 0) {
+                return -1;
+            }
+            has_some = 1;
+        } else if (matchPrefix(&cur, "full", 4)) {
+            if (parsePressureLine(&cur, stats->full, &stats->full_total) != 0) {
+                return -1;
+            }
+            stats->has_full = 1;
+        }
+        skipLine(&cur);
+    }
+    return has_some ? 0 : -1;
+}
+
+/**
+ * readPressure - Read and parse one /proc/pressure file
+ * Returns: 0 on success, -1 if PSI is unavailable or the file is malformed
+ */
+int readPressure(enum PressureResource res, struct PressureStats *stats) {
+    ssize_t len = readProcSource(&pressureSources[res]);
+    if (len == -1) {
+        return -1;
+    }
+    return parsePressure(pressureSources[res].buf, (size_t)len, stats);
+}
+
+/**
+ * armPressureTrigger - Open a pressure file and register a "some" stall trigger
+ * Returns: Trigger descriptor, or -1 if the kernel refused it
+ */
+static int armPressureTrigger(enum PressureResource res, unsigned int stall_us, unsigned int window_us) {
+    char trigger[64];
+    
+    int fd = open(pressureSources[res].path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    // The kernel wants the terminating NUL as part of the write
+    int len = snprintf(trigger, sizeof(trigger), "some %u %u", stall_us, window_us);
+    if (write(fd, trigger, (size_t)len + 1) == -1) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * registerPressureTriggers - Arm a stall trigger on every pressure file
+ * Returns: Number of triggers armed
+ *
+ * Tries a 1 s window first and falls back to the 2 s window that
+ * unprivileged processes are limited to. Resources that refuse both
+ * are simply left to the timed refresh.
+ */
+int registerPressureTriggers() {
+    int armed = 0;
+    
+    if (pressureTriggers.registered) {
+        for (int r = 0; r < PSI_RESOURCES; r++) {
+            armed += pressureTriggers.fd[r] != -1;
+        }
+        return armed;
+    }
+    pressureTriggers.registered = 1;
+    if (pressureStallMs == 0) {
+        return 0;
+    }
+    
+    unsigned int stall_us = (unsigned int)pressureStallMs * 1000u;
+    int last_error = 0;
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        unsigned int window_us = PSI_WINDOW_US;
+        int fd = armPressureTrigger(r, stall_us, window_us);
+        if (fd == -1 && errno == EINVAL) {
+            window_us = PSI_UNPRIV_WINDOW_US;
+            fd = armPressureTrigger(r, stall_us, window_us);
+        }
+        if (fd == -1) {
+            last_error = errno;
+        }
+        pressureTriggers.fd[r] = fd;
+        pressureTriggers.window_us[r] = window_us;
+        pressureTriggers.fired[r] = 0;
+        armed += fd != -1;
+    }
+    
+    char log_msg[128];
+    if (armed == 0) {
+        reportError("Warning: PSI triggers unavailable (%s), using timed refresh only\n", strerror(last_error));
+        snprintf(log_msg, sizeof(log_msg), "PSI triggers unavailable, using timed refresh");
+    } else {
+        snprintf(log_msg, sizeof(log_msg), "PSI triggers armed on %d resource(s): some >= %d ms per window",
+                 armed, pressureStallMs);
+    }
+    writeLog(log_msg);
+    return armed;
+}
+
+/**
+ * closePressureTriggers - Close every trigger descriptor
+ */
+void closePressureTriggers() {
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (pressureTriggers.fd[r] != -1) {
+            close(pressureTriggers.fd[r]);
+            pressureTriggers.fd[r] = -1;
+        }
+    }
+    pressureTriggers.registered = 0;
+}
+
+/**
+ * waitForPressure - Sleep until the timeout or until a PSI trigger fires
+ * @timeout_ms: Longest time to wait
+ * Returns: Bitmask of fired resources (1 << PSI_*), 0 on timeout
+ *
+ * A trigger that reports POLLERR is closed and no longer waited on.
+ * With no armed triggers this is a plain sleep.
+ */
+int waitForPressure(int timeout_ms) {
+    struct pollfd fds[PSI_RESOURCES];
+    int owner[PSI_RESOURCES];
+    struct timespec start, now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (running) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed_ms = (now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L;
+        if (elapsed_ms >= timeout_ms) {
+            return 0;
+        }
+        int remaining = timeout_ms - (int)elapsed_ms;
+        
+        int nfds = 0;
+        for (int r = 0; r < PSI_RESOURCES; r++) {
+            if (pressureTriggers.fd[r] != -1) {
+                fds[nfds].fd = pressureTriggers.fd[r];
+                fds[nfds].events = POLLPRI;
+                fds[nfds].revents = 0;
+                owner[nfds++] = r;
+            }
+        }
+        
+        if (nfds == 0) {
+            struct timespec ts = { remaining / 1000, (remaining % 1000) * 1000000L };
+            nanosleep(&ts, NULL);
+            continue;
+        }
+        
+        int ready = poll(fds, (nfds_t)nfds, remaining);
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            reportErrno("Error: poll on PSI triggers failed");
+            closePressureTriggers();
+            pressureTriggers.registered = 1; // Do not re-arm on the next call
+            continue;
+        }
+        
+        int fired = 0;
+        for (int i = 0; i < nfds; i++) {
+            int r = owner[i];
+            if (fds[i].revents & (POLLERR | POLLNVAL)) {
+                close(pressureTriggers.fd[r]);
+                pressureTriggers.fd[r] = -1;
+            } else if (fds[i].revents & POLLPRI) {
+                pressureTriggers.fired[r]++;
+                fired |= 1 << r;
+            }
+        }
+        if (fired) {
+            return fired;
+        }
+    }
+    return 0;
+}
+
+/**
+ * reportPressureAlerts - Print and log the resources whose trigger fired
+ * @fired: Bitmask returned by waitForPressure()
+ */
+void reportPressureAlerts(int fired) {
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        struct PressureStats stats;
+        char log_msg[160];
+        
+        if (!(fired & (1 << r))) {
+            continue;
+        }
+        if (readPressure(r, &stats) != 0) {
+            memset(&stats, 0, sizeof(stats));
+        }
+        snprintf(log_msg, sizeof(log_msg), "PSI alert: %s stalled >= %d ms in %u ms (some avg10 %.2f%%, full avg10 %.2f%%)",
+                 pressureNames[r], pressureStallMs, pressureTriggers.window_us[r] / 1000,
+                 stats.some[PSI_AVG10], stats.full[PSI_AVG10]);
+        emit("!!! %s\n", log_msg);
+        writeLog(log_msg);
+    }
+}
+
+/**
+ * getPressure - Display some/full stall averages for cpu, memory and io
+ */
+void getPressure() {
+    struct PressureStats stats[PSI_RESOURCES];
+    int available = 0;
+    
+    memset(stats, 0, sizeof(stats));
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (readPressure(r, &stats[r]) == 0) {
+            available |= 1 << r;
+        }
+    }
+    
+    emit("\n=== Pressure (PSI) ===\n");
+    if (available == 0) {
+        emit("Pressure stall information is not available (needs Linux 4.20+ with PSI enabled).\n\n");
+        return;
+    }
+    
+    double format_start = monotonicMicros();
+    emit("%-8s %8s %8s %8s   %8s %8s %8s %7s\n", "Resource", "some 10s", "60s", "300s",
+           "full 10s", "60s", "300s", "Alerts");
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (!(available & (1 << r))) {
+            emit("%-8s %8s\n", pressureNames[r], "n/a");
+            continue;
+        }
+        
+        const struct PressureStats *s = &stats[r];
+        emit("%-8s %7.2f%% %7.2f%% %7.2f%%   ", pressureNames[r],
+               s->some[PSI_AVG10], s->some[PSI_AVG60], s->some[PSI_AVG300]);
+        if (s->has_full) {
+            emit("%7.2f%% %7.2f%% %7.2f%%", s->full[PSI_AVG10], s->full[PSI_AVG60], s->full[PSI_AVG300]);
+        } else {
+            emit("%8s %8s %8s", "-", "-", "-");
+        }
+        if (pressureTriggers.fd[r] != -1) {
+            emit(" %7lu\n", pressureTriggers.fired[r]);
+        } else {
+            emit(" %7s\n", "-");
+        }
+    }
+    emit("\n");
+    stopFormatTimer(format_start);
+    
+    char log_msg[256];
+    snprintf(log_msg, sizeof(log_msg), "Pressure: some avg10 cpu %.2f%%, memory %.2f%%, io %.2f%%",
+             stats[PSI_CPU].some[PSI_AVG10], stats[PSI_MEMORY].some[PSI_AVG10], stats[PSI_IO].some[PSI_AVG10]);
+    writeLog(log_msg);
+}
+
+// ==================== TOP PROCESSES MODULE (CONTRIBUTOR 3) ====================
+
+// comm is at most 15 characters, but workqueue threads append a
+// "-<workqueue>" suffix; longer names are truncated
+#define PROC_COMM_LEN 32
+
+//Structure to store process information
+struct ProcessInfo {   
+    int pid;
+    unsigned long long starttime; // Start time in clock ticks after boot (stat field 22)
+    char name[PROC_COMM_LEN]; // comm, truncated to a fixed compact width
+    unsigned int cmdline;     // Offsets + 1 of lazily fetched details in detailPool,
+    unsigned int user;        //   0 = not fetched (only displayed rows are fetched)
+    unsigned int cgroup;
+    unsigned long utime;      // User mode CPU time
+    unsigned long stime;      // Kernel mode CPU time
+    unsigned long total_time; // Total CPU time
+    char state;               // R, S, D, Z, ... (stat field 3)
+    int ppid;
+    long num_threads;
+    unsigned long long minflt;    // Cumulative minor faults
+    unsigned long long majflt;    // Cumulative major faults
+    unsigned long long vsize;     // Virtual memory size in bytes
+    unsigned long long rss;       // Resident set size in pages
+    unsigned long long pss;       // Proportional set size in kB (smaps_rollup)
+    unsigned long long swap;      // Swapped-out memory in kB (smaps_rollup)
+    int rollup;                   // pss/swap were read this scan (-s pss candidates only)
+    unsigned long long nvcsw;     // Cumulative voluntary context switches (status,
+    unsigned long long nivcsw;    //   read only with -s cswch/nvcswch)
+    int has_switches;             // nvcsw/nivcsw were read this scan
+    double cpu_percent;       // CPU usage over the last scan interval
+    double minflt_rate;       // Per-second rates over the last scan interval
+    double majflt_rate;
+    double nvcsw_rate;
+    double nivcsw_rate;
+    int dir_fd;               // Held /proc/[PID] descriptor while displayed, else -1
+    unsigned int seen;        // Scan generation that last saw this process
+};
+
+/*
+ * Fields of /proc/[PID]/stat, numbered as in proc(5). Kernels before 3.5
+ * stop earlier; newer kernels may append fields, which are ignored.
+ */
+enum ProcStatField {
+    PSTAT_PID = 1, PSTAT_COMM, PSTAT_STATE, PSTAT_PPID, PSTAT_PGRP, PSTAT_SESSION,
+    PSTAT_TTY_NR, PSTAT_TPGID, PSTAT_FLAGS, PSTAT_MINFLT, PSTAT_CMINFLT, PSTAT_MAJFLT,
+    PSTAT_CMAJFLT, PSTAT_UTIME, PSTAT_STIME, PSTAT_CUTIME, PSTAT_CSTIME, PSTAT_PRIORITY,
+    PSTAT_NICE, PSTAT_NUM_THREADS, PSTAT_ITREALVALUE, PSTAT_STARTTIME, PSTAT_VSIZE,
+    PSTAT_RSS, PSTAT_RSSLIM, PSTAT_STARTCODE, PSTAT_ENDCODE, PSTAT_STARTSTACK,
+    PSTAT_KSTKESP, PSTAT_KSTKEIP, PSTAT_SIGNAL, PSTAT_BLOCKED, PSTAT_SIGIGNORE,
+    PSTAT_SIGCATCH, PSTAT_WCHAN, PSTAT_NSWAP, PSTAT_CNSWAP, PSTAT_EXIT_SIGNAL,
+    PSTAT_PROCESSOR, PSTAT_RT_PRIORITY, PSTAT_POLICY, PSTAT_DELAYACCT_BLKIO_TICKS,
+    PSTAT_GUEST_TIME, PSTAT_CGUEST_TIME, PSTAT_START_DATA, PSTAT_END_DATA,
+    PSTAT_START_BRK, PSTAT_ARG_START, PSTAT_ARG_END, PSTAT_ENV_START, PSTAT_ENV_END,
+    PSTAT_EXIT_CODE,
+    PROC_STAT_FIELDS = PSTAT_EXIT_CODE
+};
+
+// Parsed /proc/[PID]/stat line
+struct ProcessStat {
+    char name[PROC_COMM_LEN];     // Field 2, truncated to PROC_COMM_LEN - 1
+    char state;                   // Field 3
+    int count;                    // Number of fields the kernel provided
+    // Indexed by enum ProcStatField; missing fields are 0. Signed fields
+    // (priority, nice, ...) are stored two's complement: cast to long long.
+    unsigned long long field[PROC_STAT_FIELDS + 1];
+};
+
+/**
+ * isNumeric - Check if string contains only digits (helper for PID detection)
+ */
+int isNumeric(const char *str) {
+    if (str == NULL || *str == '\0') {
+        return 0;
+    }
+    
+    while (*str) {
+        if (*str < '0' || *str > '9') {
+            return 0;
+        }
+        str++;
+    }
+    return 1;
+}
+
+// Directory entry layout returned by getdents64(2); glibc has no wrapper
+struct linux_dirent64 {
+    unsigned long long d_ino;
+    long long d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+#define PID_ENUM_BUF_SIZE (128 * 1024)
+
+// Batched /proc scanner; the descriptor and both buffers are reused every tick
+struct PidEnumerator {
+    int fd;             // Held /proc directory descriptor
+    char *buf;          // getdents64 batch buffer
+    int *pids;          // PIDs found by the last scan
+    size_t count;
+    size_t capacity;
+};
+
+static struct PidEnumerator procEnumerator = { -1, NULL, NULL, 0, 0 };
+
+/**
+ * parsePid - Convert a /proc entry name to a PID in one pass
+ * Returns: PID, or -1 if the name is not purely numeric
+ */
+int parsePid(const char *name) {
+    unsigned int pid = 0;
+    
+    if (*name == '\0') {
+        return -1;
+    }
+    
+    for (; *name; name++) {
+        unsigned int digit = (unsigned int)(*name - '0');
+        if (digit > 9 || pid > 0x7fffffff / 10) {
+            return -1;
+        }
+        pid = pid * 10 + digit;
+    }
+    return (int)pid;
+}
+
+/**
+ * openProcDir - Open the held /proc directory descriptor on first use
+ * Returns: Descriptor, or -1 on error
+ */
+int openProcDir(struct PidEnumerator *e) {
+    if (e->fd == -1) {
+        e->fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+    return e->fd;
+}
+
+/**
+ * enumeratePids - Collect all PIDs in /proc with batched getdents64 calls
+ * Returns: Number of PIDs in e->pids, or -1 on error
+ */
+int enumeratePids(struct PidEnumerator *e) {
+    if (openProcDir(e) == -1) {
+        return -1;
+    }
+    if (e->buf == NULL) {
+        e->buf = malloc(PID_ENUM_BUF_SIZE);
+        if (e->buf == NULL) {
+            return -1;
+        }
+    }
+    
+    if (lseek(e->fd, 0, SEEK_SET) == -1) {
+        return -1;
+    }
+    
+    e->count = 0;
+    for (;;) {
+        long nread = syscall(SYS_getdents64, e->fd, e->buf, PID_ENUM_BUF_SIZE);
+        if (nread == -1) {
+            return -1;
+        }
+        if (nread == 0) {
+            break;
+        }
+        
+        for (long off = 0; off < nread; ) {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(e->buf + off);
+            off += d->d_reclen;
+            
+            // PID directories are the only numeric entries; skip the rest early
+            if (d->d_name[0] < '0' || d->d_name[0] > '9') {
+                continue;
+            }
+            int pid = parsePid(d->d_name);
+            if (pid < 0) {
+                continue;
+            }
+            
+            if (e->count == e->capacity) {
+                size_t new_capacity = e->capacity ? e->capacity * 2 : 1024;
+                int *pids = realloc(e->pids, new_capacity * sizeof(*pids));
+                if (pids == NULL) {
+                    return -1;
+                }
+                e->pids = pids;
+                e->capacity = new_capacity;
+            }
+            e->pids[e->count++] = pid;
+        }
+    }
+    
+    return (int)e->count;
+}
+
+/**
+ * closePidEnumerator - Release the /proc descriptor and scan buffers
+ */
+void closePidEnumerator(struct PidEnumerator *e) {
+    if (e->fd != -1) {
+        close(e->fd);
+        e->fd = -1;
+    }
+    free(e->buf);
+    free(e->pids);
+    e->buf = NULL;
+    e->pids = NULL;
+    e->count = e->capacity = 0;
+}
+
+/**
+ * formatPidPath - Build the relative path "<pid>/<file>" without snprintf
+ * @out: Output buffer of at least 16 + strlen(file) bytes
+ */
+void formatPidPath(char *out, int pid, const char *file) {
+    char digits[12];
+    int n = 0;
+    unsigned int value = (unsigned int)pid;
+    
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    
+    while (n > 0) {
+        *out++ = digits[--n];
+    }
+    *out++ = '/';
+    
+    size_t len = strlen(file);
+    memcpy(out, file, len + 1);
+}
+
+/*
+ * Process table that persists across ticks. Entries are stored densely in
+ * a heap arena that grows geometrically and is never shrunk, and are found
+ * through an open-addressing PID index kept at most half full. An entry is
+ * identified by (pid, starttime), so a reused PID shows up as a new
+ * process rather than inheriting the old one's counters and name.
+ */
+#define PROC_TABLE_MIN 256
+
+struct ProcessSample;
+
+struct ProcessTable {
+    struct ProcessInfo *entries;
+    int count;
+    int capacity;
+    int *index;                 // Entry index + 1, 0 = empty slot
+    unsigned int index_mask;    // Index size - 1 (size is a power of two)
+    unsigned int generation;    // Incremented once per scan
+    double scanned_at;          // CLOCK_BOOTTIME seconds of the latest scan (0 = none)
+    double elapsed;             // Seconds since the previous scan (0 = no interval yet)
+    struct ProcessSample *samples; // Per-PID collection results, reused every scan
+    int samples_capacity;
+};
+
+static struct ProcessTable processTable;
+
+/*
+ * Append-only pool for expensive per-process details (command line, user,
+ * cgroup). Only the processes that are displayed fetch them; the pool is
+ * emptied every tick.
+ */
+struct StringPool {
+    char *data;
+    size_t used;
+    size_t capacity;
+};
+
+static struct StringPool detailPool;
+
+// Direct-mapped UID -> user name cache so NSS is not queried every tick
+#define USER_CACHE_SIZE 64
+
+struct UserCacheEntry {
+    int used;
+    uid_t uid;
+    char name[32];
+};
+
+static struct UserCacheEntry userCache[USER_CACHE_SIZE];
+
+// How per-process CPU% is normalized
+enum CpuNormalize {
+    NORMALIZE_CORE,     // 100% = one core fully busy (like top)
+    NORMALIZE_MACHINE   // 100% = every online core fully busy
+};
+
+static enum CpuNormalize procCpuNormalize = NORMALIZE_CORE;
+
+// Delay between the two scans needed when no previous scan exists
+#define PROC_FIRST_SAMPLE_MS 500
+
+// Number of processes shown in the top list (-k, 1-TOP_COUNT_MAX)
+static int topCount = 5;
+#define TOP_COUNT_MAX 1000
+
+// What the top list is ranked by (-s)
+enum ProcessSort {
+    SORT_CPU,       // CPU% over the last scan interval
+    SORT_MEM,       // Resident set size (stat field 24, no extra read)
+    SORT_PSS,       // PSS from smaps_rollup, read only for RSS-ranked candidates
+    SORT_MINFLT,    // Minor faults per second (stat, no extra read)
+    SORT_MAJFLT,    // Major faults per second (stat, no extra read)
+    SORT_CSWCH,     // Voluntary context switches per second (status, read every scan)
+    SORT_NVCSWCH    // Involuntary context switches (preemptions) per second
+};
+
+#define SORT_BY_MEMORY(s) ((s) == SORT_MEM || (s) == SORT_PSS)
+#define SORT_BY_SWITCHES(s) ((s) == SORT_CSWCH || (s) == SORT_NVCSWCH)
+
+static enum ProcessSort processSort = SORT_CPU;
+
+// With -s pss, smaps_rollup is read for this many of the largest RSS
+#define PSS_CANDIDATES(k) (2 * (k) + 8)
+
+// Ranking of the current scan, fed while the table is updated
+static struct TopK processRanking;
+
+// Displayed processes resolved from processRanking, sized for topCount
+static struct ProcessInfo **rankedProcesses;
+static int rankedCapacity;
+
+/**
+ * hashPid - Home slot of a PID in the table index
+ */
+static inline unsigned int hashPid(int pid, unsigned int mask) {
+    return ((unsigned int)pid * 2654435761u) & mask;
+}
+
+/**
+ * findProcessSlot - Index slot holding a PID, or the empty slot where it would go
+ */
+unsigned int findProcessSlot(const struct ProcessTable *table, int pid) {
+    unsigned int slot = hashPid(pid, table->index_mask);
+    while (table->index[slot] != 0 && table->entries[table->index[slot] - 1].pid != pid) {
+        slot = (slot + 1) & table->index_mask;
+    }
+    return slot;
+}
+
+/**
+ * findProcess - Look up a PID in the process table
+ * Returns: Entry, or NULL if the PID is not in the table
+ */
+struct ProcessInfo *findProcess(const struct ProcessTable *table, int pid) {
+    if (table->count == 0) {
+        return NULL;
+    }
+    unsigned int slot = findProcessSlot(table, pid);
+    return table->index[slot] ? &table->entries[table->index[slot] - 1] : NULL;
+}
+
+/**
+ * growProcessTable - Double the entry arena and PID index
+ * Returns: 0 on success, -1 on allocation failure
+ *
+ * Entry pointers into the table are invalidated.
+ */
+int growProcessTable(struct ProcessTable *table) {
+    int capacity = table->capacity ? table->capacity * 2 : PROC_TABLE_MIN;
+    struct ProcessInfo *entries = realloc(table->entries, (size_t)capacity * sizeof(*entries));
+    if (entries == NULL) {
+        return -1;
+    }
+    table->entries = entries;
+    
+    // Index has twice as many slots as the arena, so it stays at most half full
+    unsigned int index_size = (unsigned int)capacity * 2;
+    int *index = calloc(index_size, sizeof(*index));
+    if (index == NULL) {
+        return -1;
+    }
+    free(table->index);
+    table->index = index;
+    table->index_mask = index_size - 1;
+    table->capacity = capacity;
+    
+    for (int i = 0; i < table->count; i++) {
+        table->index[findProcessSlot(table, table->entries[i].pid)] = i + 1;
+    }
+    return 0;
+}
+
+/**
+ * insertProcess - Add a new, zeroed entry for a PID
+ * Returns: Entry, or NULL on allocation failure
+ */
+struct ProcessInfo *insertProcess(struct ProcessTable *table, int pid) {
+    if (table->count == table->capacity && growProcessTable(table) != 0) {
+        return NULL;
+    }
+    
+    struct ProcessInfo *proc = &table->entries[table->count];
+    memset(proc, 0, sizeof(*proc));
+    proc->pid = pid;
+    proc->dir_fd = -1;
+    table->index[findProcessSlot(table, pid)] = ++table->count;
+    return proc;
+}
+
+/**
+ * removeProcess - Remove an entry, moving the last entry into its place
+ *
+ * Uses backward-shift deletion so the index never needs tombstones.
+ */
+void removeProcess(struct ProcessTable *table, int i) {
+    struct ProcessInfo *proc = &table->entries[i];
+    if (proc->dir_fd != -1) {
+        close(proc->dir_fd);
+    }
+    
+    unsigned int hole = findProcessSlot(table, proc->pid);
+    unsigned int mask = table->index_mask;
+    unsigned int next = (hole + 1) & mask;
+    while (table->index[next] != 0) {
+        unsigned int home = hashPid(table->entries[table->index[next] - 1].pid, mask);
+        // Shift back entries whose probe path passes through the hole
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            table->index[hole] = table->index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    table->index[hole] = 0;
+    
+    int last = --table->count;
+    if (i != last) {
+        table->entries[i] = table->entries[last];
+        table->index[findProcessSlot(table, table->entries[i].pid)] = i + 1;
+    }
+}
+
+/**
+ * trackProcesses - Hold /proc/[PID] descriptors for exactly this entry set
+ *
+ * Descriptors of other entries are closed; new ones are opened relative
+ * to the held /proc descriptor. A held descriptor always refers to the
+ * original process, so reads through it fail once that process exits
+ * even if its PID has been reused.
+ */
+void trackProcesses(struct ProcessTable *table, struct ProcessInfo **tracked, int count) {
+    for (int i = 0; i < table->count; i++) {
+        struct ProcessInfo *proc = &table->entries[i];
+        if (proc->dir_fd == -1) {
+            continue;
+        }
+        int keep = 0;
+        for (int j = 0; j < count; j++) {
+            if (tracked[j] == proc) {
+                keep = 1;
+                break;
+            }
+        }
+        if (!keep) {
+            close(proc->dir_fd);
+            proc->dir_fd = -1;
+        }
+    }
+    
+    int proc_fd = openProcDir(&procEnumerator);
+    for (int j = 0; j < count && proc_fd != -1; j++) {
+        if (tracked[j]->dir_fd != -1) {
+            continue;
+        }
+        char path[16];
+        formatPidPath(path, tracked[j]->pid, "");
+        tracked[j]->dir_fd = openat(proc_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+}
+
+/**
+ * freeProcessTable - Remove every entry, close held descriptors and free the arena
+ */
+void freeProcessTable(struct ProcessTable *table) {
+    while (table->count > 0) {
+        removeProcess(table, table->count - 1);
+    }
+    free(table->entries);
+    free(table->index);
+    free(table->samples);
+    table->entries = NULL;
+    table->index = NULL;
+    table->samples = NULL;
+    table->samples_capacity = 0;
+    table->capacity = 0;
+    table->index_mask = 0;
+}
+
+/**
+ * appendToPool - Copy a string into the pool
+ * Returns: Offset + 1 of the copy, or 0 on allocation failure
+ */
+unsigned int appendToPool(struct StringPool *pool, const char *str, size_t len) {
+    if (pool->used + len + 1 > pool->capacity) {
+        size_t capacity = pool->capacity ? pool->capacity : 4096;
+        while (pool->used + len + 1 > capacity) {
+            capacity *= 2;
+        }
+        char *data = realloc(pool->data, capacity);
+        if (data == NULL) {
+            return 0;
+        }
+        pool->data = data;
+        pool->capacity = capacity;
+    }
+    
+    unsigned int offset = (unsigned int)pool->used;
+    memcpy(pool->data + offset, str, len);
+    pool->data[offset + len] = '\0';
+    pool->used += len + 1;
+    return offset + 1;
+}
+
+/**
+ * poolString - String stored at a pool reference, or NULL for 0
+ */
+const char *poolString(const struct StringPool *pool, unsigned int ref) {
+    return ref ? pool->data + ref - 1 : NULL;
+}
+
+/**
+ * freeStringPool - Release pool storage
+ */
+void freeStringPool(struct StringPool *pool) {
+    free(pool->data);
+    memset(pool, 0, sizeof(*pool));
+}
+
+/**
+ * openProcessFile - Open /proc/[PID]/<file> relative to a held descriptor
+ * @pid_fd: Held /proc/[PID] descriptor, or -1 to go through the /proc descriptor
+ * Returns: Open descriptor, or -1 on error
+ */
+int openProcessFile(int pid, int pid_fd, const char *file) {
+    if (pid_fd != -1) {
+        return openat(pid_fd, file, O_RDONLY | O_CLOEXEC);
+    }
+    
+    int proc_fd = openProcDir(&procEnumerator);
+    if (proc_fd == -1) {
+        return -1;
+    }
+    
+    char path[64];
+    if (strlen(file) > sizeof(path) - 16) {
+        return -1;
+    }
+    formatPidPath(path, pid, file);
+    return openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * readProcessCmdline - Read /proc/[PID]/cmdline with arguments joined by spaces
+ * @pid_fd: Held /proc/[PID] descriptor, or -1
+ * Returns: Length of the command line (0 for kernel threads), or -1 on error
+ */
+int readProcessCmdline(int pid, int pid_fd, char *cmdline, size_t size) {
+    int fd = openProcessFile(pid, pid_fd, "cmdline");
+    if (fd == -1) {
+        return -1;
+    }
+    
+    ssize_t bytes_read = read(fd, cmdline, size - 1);
+    close(fd);
+    if (bytes_read < 0) {
+        return -1;
+    }
+    
+    // Arguments are NUL-separated; drop the trailing terminators
+    while (bytes_read > 0 && cmdline[bytes_read - 1] == '\0') {
+        bytes_read--;
+    }
+    for (ssize_t i = 0; i < bytes_read; i++) {
+        if (cmdline[i] == '\0') {
+            cmdline[i] = ' ';
+        }
+    }
+    sanitizeText(cmdline, (size_t)bytes_read);
+    cmdline[bytes_read] = '\0';
+    return (int)bytes_read;
+}
+
+/**
+ * lookupUserName - Resolve a UID to a user name through the cache
+ * Returns: Cached name (the numeric UID if it has no passwd entry)
+ */
+const char *lookupUserName(uid_t uid) {
+    struct UserCacheEntry *entry = &userCache[uid % USER_CACHE_SIZE];
+    
+    if (!entry->used || entry->uid != uid) {
+        struct passwd pwd;
+        struct passwd *result = NULL;
+        char buf[1024];
+        
+        if (getpwuid_r(uid, &pwd, buf, sizeof(buf), &result) == 0 && result != NULL) {
+            snprintf(entry->name, sizeof(entry->name), "%s", result->pw_name);
+        } else {
+            snprintf(entry->name, sizeof(entry->name), "%u", (unsigned int)uid);
+        }
+        entry->uid = uid;
+        entry->used = 1;
+    }
+    return entry->name;
+}
+
+// Per-thread buffer for /proc/[PID]/status, kept at the largest size seen
+#define PROC_STATUS_MIN_BUF 4096
+static __thread char *statusBuffer;
+static __thread size_t statusCapacity;
+
+/**
+ * readProcessStatus - Read the whole of /proc/[PID]/status into statusBuffer
+ * Returns: Number of bytes read (NUL-terminated), or -1 on error
+ *
+ * The file's size depends on the host (Groups:, Cpus_allowed_list and
+ * Mems_allowed grow with groups, CPUs and NUMA nodes), so it is read
+ * to EOF, doubling the buffer whenever it fills.
+ */
+ssize_t readProcessStatus(int pid, int pid_fd) {
+    int fd = openProcessFile(pid, pid_fd, "status");
+    if (fd == -1) {
+        return -1;
+    }
+    
+    size_t used = 0;
+    for (;;) {
+        if (used + 1 >= statusCapacity) {
+            size_t cap = statusCapacity ? statusCapacity * 2 : PROC_STATUS_MIN_BUF;
+            char *grown = realloc(statusBuffer, cap);
+            if (grown == NULL) {
+                close(fd);
+                return -1;
+            }
+            statusBuffer = grown;
+            statusCapacity = cap;
+        }
+        ssize_t n = read(fd, statusBuffer + used, statusCapacity - 1 - used);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        used += (size_t)n;
+    }
+    close(fd);
+    statusBuffer[used] = '\0';
+    return used > 0 ? (ssize_t)used : -1;
+}
+
+/**
+ * freeStatusBuffer - Release this thread's status buffer
+ */
+void freeStatusBuffer() {
+    free(statusBuffer);
+    statusBuffer = NULL;
+    statusCapacity = 0;
+}
+
+/**
+ * readProcessUser - Read the real UID from /proc/[PID]/status
+ * Returns: 0 on success, -1 on error
+ */
+int readProcessUser(int pid, int pid_fd, uid_t *uid) {
+    ssize_t bytes_read = readProcessStatus(pid, pid_fd);
+    if (bytes_read == -1) {
+        return -1;
+    }
+    
+    const char *buffer = statusBuffer;
+    const char *line = strstr(buffer, "\nUid:");
+    if (line == NULL) {
+        return -1;
+    }
+    
+    struct ProcCursor cur;
+    unsigned long long value;
+    initCursor(&cur, line + 5, (size_t)(buffer + bytes_read - line - 5));
+    if (parseUnsigned(&cur, &value) != 0 || value > UINT32_MAX) {
+        return -1;
+    }
+    *uid = (uid_t)value;
+    return 0;
+}
+
+/**
+ * readProcessSwitches - Read context switch counts from /proc/[PID]/status
+ * @nvcsw: Voluntary switches (the task blocked or yielded)
+ * @nivcsw: Involuntary switches (the task was preempted)
+ * Returns: 0 on success, -1 on error
+ */
+int readProcessSwitches(int pid, int pid_fd, unsigned long long *nvcsw, unsigned long long *nivcsw) {
+    // The two counters are the last lines of status
+    ssize_t bytes_read = readProcessStatus(pid, pid_fd);
+    if (bytes_read == -1) {
+        return -1;
+    }
+    
+    const char *buffer = statusBuffer;
+    const char *line = strstr(buffer, "\nvoluntary_ctxt_switches:");
+    if (line == NULL) {
+        return -1;
+    }
+    
+    struct ProcCursor cur;
+    initCursor(&cur, line + 25, (size_t)(buffer + bytes_read - line - 25));
+    if (parseUnsigned(&cur, nvcsw) != 0 || !skipLine(&cur) ||
+        !matchPrefix(&cur, "nonvoluntary_ctxt_switches:", 27) || parseUnsigned(&cur, nivcsw) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * readProcessCgroup - Read the cgroup path from /proc/[PID]/cgroup
+ * Returns: Length of the path, or -1 on error
+ *
+ * Uses the unified (cgroup v2) "0::" entry when present, otherwise the
+ * path of the first v1 hierarchy listed.
+ */
+int readProcessCgroup(int pid, int pid_fd, char *path, size_t size) {
+    char buffer[4096];
+    int fd = openProcessFile(pid, pid_fd, "cgroup");
+    if (fd == -1) {
+        return -1;
+    }
+    
+    ssize_t bytes_read = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (bytes_read <= 0) {
+        return -1;
+    }
+    buffer[bytes_read] = '\0';
+    
+    const char *line = strncmp(buffer, "0::", 3) == 0 ? buffer : strstr(buffer, "\n0::");
+    if (line == NULL) {
+        line = buffer;
+    } else if (*line == '\n') {
+        line++;
+    }
+    
+    // Line format: hierarchy-ID:controllers:path
+    const char *start = strchr(line, ':');
+    start = start ? strchr(start + 1, ':') : NULL;
+    if (start == NULL) {
+        return -1;
+    }
+    start++;
+    
+    size_t len = strcspn(start, "\n");
+    if (len > size - 1) {
+        len = size - 1;
+    }
+    memcpy(path, start, len);
+    path[len] = '\0';
+    return (int)len;
+}
+
+/**
+ * fetchProcessDetails - Load command line, user and cgroup of the given entries
+ *
+ * These cost extra file reads per process, so they are only fetched for
+ * the rows being displayed or exported. The pool is emptied first, so
+ * only these entries hold valid references afterwards.
+ */
+void fetchProcessDetails(struct ProcessInfo **procs, int count) {
+    char buffer[4096];
+    
+    detailPool.used = 0;
+    for (int i = 0; i < count; i++) {
+        struct ProcessInfo *proc = procs[i];
+        
+        // comm is refreshed from stat every scan, so clean it for display here
+        sanitizeText(proc->name, strlen(proc->name));
+        
+        int len = readProcessCmdline(proc->pid, proc->dir_fd, buffer, sizeof(buffer));
+        if (len > 0) {
+            proc->cmdline = appendToPool(&detailPool, buffer, (size_t)len);
+        }
+        
+        uid_t uid;
+        if (readProcessUser(proc->pid, proc->dir_fd, &uid) == 0) {
+            const char *user = lookupUserName(uid);
+            proc->user = appendToPool(&detailPool, user, strlen(user));
+        }
+        
+        len = readProcessCgroup(proc->pid, proc->dir_fd, buffer, sizeof(buffer));
+        if (len > 0) {
+            sanitizeText(buffer, (size_t)len);
+            proc->cgroup = appendToPool(&detailPool, buffer, (size_t)len);
+        }
+    }
+}
+
+/*
+ * Space scanning for the stat tokenizer. The fields after comm are marked
+ * in a bitmap (bit i set = byte i is a space) in one pass, 16 or 32 bytes
+ * at a time where SSE2/AVX2 are available, and the fields are then walked
+ * with count-trailing-zeros instead of searching byte by byte. The
+ * implementation is chosen once at runtime from the CPU's features.
+ */
+#define PROC_STAT_COMM_MAX 64       // Kernel limit for comm incl. workqueue suffix
+#define PROC_STAT_TAIL_MAX 1280     // 50 fields of up to 20 digits plus spaces
+#define PROC_STAT_MASK_WORDS (PROC_STAT_TAIL_MAX / 64)
+
+typedef void (*SpaceMaskFn)(const char *p, size_t len, uint64_t *mask);
+
+#ifdef HAVE_X86_SIMD
+/**
+ * maskSpacesSSE2 - Space bitmap, 16 bytes per compare
+ */
+__attribute__((target("sse2")))
+static void maskSpacesSSE2(const char *p, size_t len, uint64_t *mask) {
+    const __m128i spaces = _mm_set1_epi8(' ');
+    size_t i = 0;
+    
+    memset(mask, 0, ((len + 63) / 64) * sizeof(*mask));
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(p + i));
+        uint64_t bits = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, spaces));
+        mask[i >> 6] |= bits << (i & 63);
+    }
+    for (; i < len; i++) {
+        mask[i >> 6] |= (uint64_t)(p[i] == ' ') << (i & 63);
+    }
+}
+
+/**
+ * maskSpacesAVX2 - Space bitmap, 32 bytes per compare
+ */
+__attribute__((target("avx2")))
+static void maskSpacesAVX2(const char *p, size_t len, uint64_t *mask) {
+    const __m256i spaces = _mm256_set1_epi8(' ');
+    size_t i = 0;
+    
+    memset(mask, 0, ((len + 63) / 64) * sizeof(*mask));
+    for (; i + 32 <= len; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(p + i));
+        uint64_t bits = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, spaces));
+        mask[i >> 6] |= bits << (i & 63);
+    }
+    for (; i < len; i++) {
+        mask[i >> 6] |= (uint64_t)(p[i] == ' ') << (i & 63);
+    }
+}
+#endif
+
+static SpaceMaskFn maskSpaces = NULL;    // NULL: walkStatFields()
+static pthread_once_t maskSpacesOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * selectMaskSpaces - Pick the widest space scanner this CPU supports
+ */
+static void selectMaskSpaces() {
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        maskSpaces = maskSpacesAVX2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        maskSpaces = maskSpacesSSE2;
+    }
+#endif
+}
+
+/**
+ * storeStatField - Store field number @field spanning [start, end)
+ * Returns: 0 on success (fields beyond PROC_STAT_FIELDS are ignored), -1 on error
+ */
+static inline int storeStatField(struct ProcessStat *stat, int field, const char *start, const char *end) {
+    if (field > PROC_STAT_FIELDS) {
+        return 0;
+    }
+    if (field == PSTAT_STATE) {
+        if (end - start != 1) {
+            return -1;
+        }
+        stat->state = *start;
+        stat->field[PSTAT_STATE] = (unsigned char)*start;
+        return 0;
+    }
+    
+    // Unsigned fields (e.g. rsslim) may use the full 64-bit range
+    struct ProcCursor cur = { start, end };
+    int failed = *start == '-' ? parseSigned(&cur, &stat->field[field])
+                               : parseUnsigned(&cur, &stat->field[field]);
+    if (failed) {
+        return -1;
+    }
+    return cur.p == end || *cur.p == '\n' ? 0 : -1;
+}
+
+/**
+ * walkStatFields - Parse the fields after comm left to right without a space bitmap
+ * @p: First byte of the state field
+ * Returns: Number of the field after the last one stored, or -1 on error
+ *
+ * Without SIMD, building the bitmap a byte at a time costs more than it
+ * saves, so the scalar path lets the number parser find each field's end.
+ */
+static int walkStatFields(struct ProcessStat *stat, const char *p, const char *end) {
+    if (end - p < 2 || (p[1] != ' ' && p[1] != '\n')) {
+        return -1;
+    }
+    stat->state = *p;
+    stat->field[PSTAT_STATE] = (unsigned char)*p;
+    p += 2;
+    
+    int field = PSTAT_STATE + 1;
+    for (; field <= PROC_STAT_FIELDS && p < end && *p != '\n'; field++) {
+        struct ProcCursor cur = { p, end };
+        if (*p == ' ' || (*p == '-' ? parseSigned(&cur, &stat->field[field])
+                                    : parseUnsigned(&cur, &stat->field[field])) != 0) {
+            return -1;
+        }
+        if (cur.p < end && *cur.p != ' ' && *cur.p != '\n') {
+            return -1;
+        }
+        p = cur.p + 1;
+    }
+    return field;
+}
+
+/**
+ * parseProcessStat - Tokenize a /proc/[PID]/stat line into all of its fields
+ * @len: Length of the line in buffer (need not be NUL-terminated)
+ * Returns: 0 on success, -1 if the line is malformed or ends before starttime
+ */
+int parseProcessStat(const char *buffer, size_t len, struct ProcessStat *stat) {
+    // Format: pid (comm) state ppid pgrp ... (see enum ProcStatField)
+    const char *end = buffer + len;
+    const char *open_paren = memchr(buffer, '(', len < 24 ? len : 24);
+    if (open_paren == NULL) {
+        return -1;
+    }
+    
+    // comm may itself contain spaces and ')', so it ends at the LAST ')'.
+    // Everything after comm is numeric, and comm is bounded, so searching
+    // back from the longest possible comm finds it without scanning the line.
+    const char *close_paren = open_paren + 1 + PROC_STAT_COMM_MAX;
+    if (close_paren >= end) {
+        close_paren = end - 1;
+    }
+    while (close_paren > open_paren && *close_paren != ')') {
+        close_paren--;
+    }
+    if (close_paren == open_paren) {
+        return -1;
+    }
+    
+    memset(stat, 0, sizeof(*stat));
+    struct ProcCursor pid = { buffer, open_paren };
+    if (parseUnsigned(&pid, &stat->field[PSTAT_PID]) != 0 || !matchPrefix(&pid, " ", 1)) {
+        return -1;
+    }
+    size_t name_len = (size_t)(close_paren - open_paren - 1);
+    if (name_len > sizeof(stat->name) - 1) {
+        name_len = sizeof(stat->name) - 1;
+    }
+    memcpy(stat->name, open_paren + 1, name_len);
+    
+    // Mark every space after comm; tail[0] is the space before the state
+    const char *tail = close_paren + 1;
+    size_t tail_len = (size_t)(end - tail);
+    uint64_t mask[PROC_STAT_MASK_WORDS];
+    if (tail_len < 2 || tail_len > PROC_STAT_TAIL_MAX || *tail != ' ') {
+        return -1;
+    }
+    pthread_once(&maskSpacesOnce, selectMaskSpaces);
+    if (maskSpaces == NULL) {
+        int field = walkStatFields(stat, tail + 1, end);
+        if (field == -1) {
+            return -1;
+        }
+        stat->count = field - 1;
+        return stat->count >= PSTAT_STARTTIME ? 0 : -1;
+    }
+    maskSpaces(tail, tail_len, mask);
+    
+    // Each space ends the previous field; the last field ends at the line end
+    int field = PSTAT_STATE;
+    const char *start = tail + 1;
+    size_t words = (tail_len + 63) / 64;
+    mask[0] &= ~(uint64_t)1;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t bits = mask[w];
+        while (bits) {
+            const char *space = tail + w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (storeStatField(stat, field++, start, space) != 0) {
+                return -1;
+            }
+            start = space + 1;
+        }
+    }
+    if (storeStatField(stat, field++, start, end) != 0) {
+        return -1;
+    }
+    
+    stat->count = (field > PROC_STAT_FIELDS + 1 ? PROC_STAT_FIELDS + 1 : field) - 1;
+    return stat->count >= PSTAT_STARTTIME ? 0 : -1;
+}
+
+/**
+ * readProcessStat - Read and parse /proc/[PID]/stat
+ * @pid_fd: Held /proc/[PID] descriptor, or -1
+ */
+int readProcessStat(int pid, int pid_fd, struct ProcessStat *stat) {
+    char buffer[4096];
+    int fd;
+    ssize_t bytes_read;
+    
+    fd = openProcessFile(pid, pid_fd, "stat");
+    if (fd == -1) {
+        return -1;
+    }
+    
+    bytes_read = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    
+    if (bytes_read <= 0) {
+        return -1;
+    }
+    
+    return parseProcessStat(buffer, (size_t)bytes_read, stat);
+}
+
+/**
+ * parseCpuNormalize - Select per-process CPU% normalization ("core" or "machine")
+ * Returns: 0 on success, -1 if the name is unknown
+ */
+int parseCpuNormalize(const char *name) {
+    if (strcmp(name, "core") == 0) {
+        procCpuNormalize = NORMALIZE_CORE;
+    } else if (strcmp(name, "machine") == 0) {
+        procCpuNormalize = NORMALIZE_MACHINE;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * parseProcessSort - Select the top-list ranking ("cpu", "mem", "pss",
+ *                    "minflt", "majflt", "cswch" or "nvcswch")
+ * Returns: 0 on success, -1 if the name is unknown
+ */
+int parseProcessSort(const char *name) {
+    if (strcmp(name, "cpu") == 0) {
+        processSort = SORT_CPU;
+    } else if (strcmp(name, "mem") == 0) {
+        processSort = SORT_MEM;
+    } else if (strcmp(name, "pss") == 0) {
+        processSort = SORT_PSS;
+    } else if (strcmp(name, "minflt") == 0) {
+        processSort = SORT_MINFLT;
+    } else if (strcmp(name, "majflt") == 0) {
+        processSort = SORT_MAJFLT;
+    } else if (strcmp(name, "cswch") == 0) {
+        processSort = SORT_CSWCH;
+    } else if (strcmp(name, "nvcswch") == 0) {
+        processSort = SORT_NVCSWCH;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * pageKilobytes - Size of a memory page in kB (RSS is counted in pages)
+ */
+long pageKilobytes() {
+    static long page_kb = 0;
+    if (page_kb == 0) {
+        long page_size = sysconf(_SC_PAGESIZE);
+        page_kb = page_size > 0 ? page_size / 1024 : 4;
+    }
+    return page_kb;
+}
+
+/**
+ * readProcessRollup - Read Pss and Swap (kB) from /proc/[PID]/smaps_rollup
+ * Returns: 0 on success, -1 on error (no permission, kernel < 4.14, exited)
+ *
+ * The kernel walks every mapping of the process to produce this file,
+ * so it is far more expensive than stat and only read for a few PIDs.
+ */
+int readProcessRollup(int pid, int pid_fd, unsigned long long *pss, unsigned long long *swap) {
+    char buffer[2048];
+    int fd = openProcessFile(pid, pid_fd, "smaps_rollup");
+    if (fd == -1) {
+        return -1;
+    }
+    
+    ssize_t bytes_read = read(fd, buffer, sizeof(buffer));
+    close(fd);
+    if (bytes_read <= 0) {
+        return -1;
+    }
+    
+    struct ProcCursor cur;
+    int found = 0;
+    initCursor(&cur, buffer, (size_t)bytes_read);
+    do {
+        if (matchPrefix(&cur, "Pss:", 4)) {
+            found += parseUnsigned(&cur, pss) == 0;
+        } else if (matchPrefix(&cur, "Swap:", 5)) {
+            found += parseUnsigned(&cur, swap) == 0;
+        }
+    } while (found < 2 && skipLine(&cur));
+    
+    return found == 2 ? 0 : -1;
+}
+
+/*
+ * Result of reading one PID during the collection phase. Collection only
+ * reads the process table, so PID shards can be collected in parallel;
+ * all table changes happen afterwards in a single-threaded merge.
+ */
+#define SAMPLE_OK       0x1     // stat was read
+#define SAMPLE_FD_STALE 0x2     // Held descriptor belongs to an exited process
+#define SAMPLE_SWITCHES 0x4     // nvcsw/nivcsw were read from status
+
+struct ProcessSample {
+    int pid;
+    int flags;
+    struct ProcessStat stat;
+    unsigned long long nvcsw;   // Only with SAMPLE_SWITCHES
+    unsigned long long nivcsw;
+};
+
+/**
+ * collectProcessSample - Read one process without modifying the table
+ */
+void collectProcessSample(const struct ProcessTable *table, int pid, struct ProcessSample *sample) {
+    const struct ProcessInfo *proc = findProcess(table, pid);
+    int pid_fd = proc ? proc->dir_fd : -1;
+    
+    sample->pid = pid;
+    sample->flags = 0;
+    
+    if (readProcessStat(pid, pid_fd, &sample->stat) != 0) {
+        if (pid_fd == -1) {
+            return; // Process may have terminated, skip it
+        }
+        // Held descriptor belongs to an exited process; the PID may be reused
+        sample->flags |= SAMPLE_FD_STALE;
+        if (readProcessStat(pid, -1, &sample->stat) != 0) {
+            return;
+        }
+    }
+    sample->flags |= SAMPLE_OK;
+}
+
+/**
+ * collectProcessSwitches - Add context switch counts to a collected sample
+ *
+ * status is several times larger than stat, so this runs only while
+ * ranking by context switches.
+ */
+void collectProcessSwitches(const struct ProcessTable *table, struct ProcessSample *sample) {
+    if (!(sample->flags & SAMPLE_OK)) {
+        return;
+    }
+    const struct ProcessInfo *proc = findProcess(table, sample->pid);
+    int pid_fd = proc && !(sample->flags & SAMPLE_FD_STALE) ? proc->dir_fd : -1;
+    
+    if (readProcessSwitches(sample->pid, pid_fd, &sample->nvcsw, &sample->nivcsw) == 0) {
+        sample->flags |= SAMPLE_SWITCHES;
+    }
+}
+
+/*
+ * io_uring collection backend (-i uring). A batch of PIDs is collected
+ * with three submissions: open every stat file, read them all, close
+ * them all. glibc has no io_uring wrappers, so
+ * the rings are set up directly with io_uring_setup(2) and mmap(2).
+ * Each collection thread lazily sets up its own ring; if the kernel lacks
+ * io_uring or the needed opcodes, that thread uses the synchronous path.
+ */
+enum CollectBackend {
+    BACKEND_SYNC,   // open/read/close per file
+    BACKEND_URING   // Batched through io_uring
+};
+
+static enum CollectBackend collectBackend = BACKEND_SYNC;
+
+#define URING_BATCH 64                  // PIDs per batch
+#define URING_ENTRIES URING_BATCH       // One file (stat) per PID
+#define URING_STAT_BUF 2048             // A stat line with all 52 fields fits easily
+#define URING_ENTER_RETRIES 16          // Failed io_uring_enter() calls tolerated while draining
+
+struct UringQueue {
+    int state;                  // 0 = not set up, 1 = ready, -1 = unavailable
+    int fd;
+    unsigned int *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned int *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    unsigned int queued;        // SQEs prepared but not yet submitted
+    unsigned int inflight;      // Submitted SQEs whose completion could not be reaped
+};
+
+// Per-PID state of one batch
+struct UringSlot {
+    int fd;
+    int len;
+    char path[24];
+    char buf[URING_STAT_BUF];
+};
+
+static __thread struct UringQueue threadRing;
+static __thread struct UringSlot *threadSlots;
+
+/**
+ * closeUring - Unmap the rings and close the io_uring descriptor of this thread
+ */
+void closeUring(struct UringQueue *q) {
+    if (q->state == 1) {
+        munmap(q->sqes, q->sqes_size);
+        if (q->cq_ring != q->sq_ring) {
+            munmap(q->cq_ring, q->cq_ring_size);
+        }
+        munmap(q->sq_ring, q->sq_ring_size);
+        close(q->fd);
+    }
+    // Operations still in flight may write into the slots: leak them
+    // rather than hand the memory back to malloc
+    if (q->inflight == 0) {
+        free(threadSlots);
+    }
+    memset(q, 0, sizeof(*q));
+    threadSlots = NULL;
+}
+
+/**
+ * setupUring - Create and map a ring, checking the opcodes we rely on
+ * Returns: 0 if the ring is usable, -1 otherwise (state is then -1)
+ */
+int setupUring(struct UringQueue *q) {
+    if (q->state != 0) {
+        return q->state == 1 ? 0 : -1;
+    }
+    q->state = -1;
+    
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    q->fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    if (q->fd < 0) {
+        return -1;
+    }
+    
+    // OPENAT, READ and CLOSE all need Linux 5.6; the probe interface too
+    size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, probe_size);
+    int supported = probe != NULL &&
+        syscall(__NR_io_uring_register, q->fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+        probe->last_op >= IORING_OP_READ &&
+        (probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED) &&
+        (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) &&
+        (probe->ops[IORING_OP_CLOSE].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    if (!supported) {
+        close(q->fd);
+        return -1;
+    }
+    
+    q->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    q->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (q->cq_ring_size > q->sq_ring_size) {
+            q->sq_ring_size = q->cq_ring_size;
+        }
+        q->cq_ring_size = q->sq_ring_size;
+    }
+    
+    q->sq_ring = mmap(NULL, q->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      q->fd, IORING_OFF_SQ_RING);
+    if (q->sq_ring == MAP_FAILED) {
+        close(q->fd);
+        return -1;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        q->cq_ring = q->sq_ring;
+    } else {
+        q->cq_ring = mmap(NULL, q->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          q->fd, IORING_OFF_CQ_RING);
+        if (q->cq_ring == MAP_FAILED) {
+            munmap(q->sq_ring, q->sq_ring_size);
+            close(q->fd);
+            return -1;
+        }
+    }
+    
+    q->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    q->sqes = mmap(NULL, q->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   q->fd, IORING_OFF_SQES);
+    threadSlots = malloc(URING_BATCH * sizeof(*threadSlots));
+    if (q->sqes == MAP_FAILED || threadSlots == NULL) {
+        if (q->sqes != MAP_FAILED) {
+            munmap(q->sqes, q->sqes_size);
+        }
+        if (q->cq_ring != q->sq_ring) {
+            munmap(q->cq_ring, q->cq_ring_size);
+        }
+        munmap(q->sq_ring, q->sq_ring_size);
+        close(q->fd);
+        free(threadSlots);
+        threadSlots = NULL;
+        return -1;
+    }
+    
+    char *sq = q->sq_ring;
+    char *cq = q->cq_ring;
+    q->sq_head = (unsigned int *)(sq + params.sq_off.head);
+    q->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+    q->sq_mask = (unsigned int *)(sq + params.sq_off.ring_mask);
+    q->sq_array = (unsigned int *)(sq + params.sq_off.array);
+    q->cq_head = (unsigned int *)(cq + params.cq_off.head);
+    q->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+    q->cq_mask = (unsigned int *)(cq + params.cq_off.ring_mask);
+    q->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    q->queued = 0;
+    q->state = 1;
+    return 0;
+}
+
+/**
+ * queueSqe - Prepare the next submission queue entry
+ */
+static struct io_uring_sqe *queueSqe(struct UringQueue *q, int opcode, int fd, unsigned long long user_data) {
+    unsigned int tail = *q->sq_tail + q->queued;
+    unsigned int idx = tail & *q->sq_mask;
+    struct io_uring_sqe *sqe = &q->sqes[idx];
+    
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (unsigned char)opcode;
+    sqe->fd = fd;
+    sqe->user_data = user_data;
+    q->sq_array[idx] = idx;
+    q->queued++;
+    return sqe;
+}
+
+/**
+ * submitAndReap - Submit queued SQEs, wait for all of them and store results
+ * @results: Indexed by user_data; receives each completion's result. Entries
+ *           the caller preset (to -ECANCELED) keep that value if no completion came.
+ * Returns: 0 on success, -1 on failure (the ring must not be used again)
+ *
+ * A failed or short submit (e.g. -EBUSY when the CQ is full) stops
+ * submitting and drains: it waits until every SQE the kernel consumed
+ * has completed, so no completion is left for the next batch to read
+ * and no operation still writes into the caller's buffers. If even
+ * that fails, q->inflight counts the lost completions.
+ */
+int submitAndReap(struct UringQueue *q, int *results) {
+    unsigned int queued = q->queued;
+    unsigned int submitted = 0;     // Consumed by the kernel
+    unsigned int reaped = 0;
+    int failed = 0;
+    int errors = 0;
+    
+    __atomic_store_n(q->sq_tail, *q->sq_tail + queued, __ATOMIC_RELEASE);
+    q->queued = 0;
+    
+    for (;;) {
+        unsigned int head = *q->cq_head;
+        unsigned int tail = __atomic_load_n(q->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const struct io_uring_cqe *cqe = &q->cqes[head & *q->cq_mask];
+            if (cqe->user_data < URING_ENTRIES) {
+                results[cqe->user_data] = cqe->res;
+            }
+            reaped++;
+        }
+        __atomic_store_n(q->cq_head, head, __ATOMIC_RELEASE);
+        
+        unsigned int to_submit = failed ? 0 : queued - submitted;
+        if (to_submit == 0 && reaped >= submitted) {
+            break;
+        }
+        
+        long ret = syscall(__NR_io_uring_enter, q->fd, to_submit, reaped < submitted ? 1 : 0,
+                           IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0) {
+            if (errno != EINTR) {
+                failed = 1;
+                if (++errors > URING_ENTER_RETRIES) {
+                    q->inflight = submitted - reaped;
+                    return -1;
+                }
+            }
+            continue;
+        }
+        if (to_submit > 0) {
+            submitted += (unsigned int)ret < to_submit ? (unsigned int)ret : to_submit;
+            if ((unsigned int)ret < to_submit) {
+                failed = 1; // The rest stays unsubmitted; the ring is abandoned
+            }
+        }
+    }
+    return failed ? -1 : 0;
+}
+
+/**
+ * closeOpenedSlots - Close the descriptors of a batch synchronously after a ring failure
+ */
+static void closeOpenedSlots(struct UringSlot *slots, int n) {
+    for (int i = 0; i < n; i++) {
+        if (slots[i].fd >= 0) {
+            close(slots[i].fd);
+            slots[i].fd = -1;
+        }
+    }
+}
+
+/**
+ * collectBatchUring - Collect samples[lo..hi) (at most URING_BATCH PIDs) through io_uring
+ * Returns: 0 on success, -1 if the ring failed (caller falls back to sync)
+ *
+ * user_data is the slot index within the batch. After a failure every
+ * descriptor the batch opened has been closed.
+ */
+int collectBatchUring(struct UringQueue *q, const struct ProcessTable *table, const int *pids,
+                      struct ProcessSample *samples, int lo, int hi) {
+    struct UringSlot *slots = threadSlots;
+    int results[URING_ENTRIES];
+    int proc_fd = procEnumerator.fd;
+    int n = hi - lo;
+    
+    // 1. Open stat for every PID
+    for (int i = 0; i < n; i++) {
+        const struct ProcessInfo *proc = findProcess(table, pids[lo + i]);
+        struct UringSlot *slot = &slots[i];
+        int dir_fd = proc && proc->dir_fd != -1 ? proc->dir_fd : proc_fd;
+        
+        slot->fd = -1;
+        slot->len = -1;
+        if (dir_fd == proc_fd) {
+            formatPidPath(slot->path, pids[lo + i], "stat");
+        } else {
+            memcpy(slot->path, "stat", 5);
+        }
+        struct io_uring_sqe *sqe = queueSqe(q, IORING_OP_OPENAT, dir_fd, (unsigned long long)i);
+        sqe->addr = (unsigned long long)(uintptr_t)slot->path;
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        results[i] = -ECANCELED;
+    }
+    int ok = submitAndReap(q, results) == 0;
+    for (int i = 0; i < n; i++) {
+        slots[i].fd = results[i];
+    }
+    if (!ok) {
+        closeOpenedSlots(slots, n);
+        return -1;
+    }
+    
+    // 2. Read every file that opened
+    for (int i = 0; i < n; i++) {
+        struct UringSlot *slot = &slots[i];
+        results[i] = -ECANCELED;
+        if (slot->fd >= 0) {
+            struct io_uring_sqe *sqe = queueSqe(q, IORING_OP_READ, slot->fd, (unsigned long long)i);
+            sqe->addr = (unsigned long long)(uintptr_t)slot->buf;
+            sqe->len = URING_STAT_BUF - 1;
+        }
+    }
+    if (submitAndReap(q, results) != 0) {
+        closeOpenedSlots(slots, n);
+        return -1;
+    }
+    
+    // 3. Close everything that opened
+    for (int i = 0; i < n; i++) {
+        struct UringSlot *slot = &slots[i];
+        slot->len = results[i];
+        results[i] = -ECANCELED;
+        if (slot->fd >= 0) {
+            queueSqe(q, IORING_OP_CLOSE, slot->fd, (unsigned long long)i);
+        }
+    }
+    if (submitAndReap(q, results) != 0) {
+        // Close what the ring did not; with completions lost (inflight)
+        // a descriptor may already be closed and its number reused
+        for (int i = 0; i < n && q->inflight == 0; i++) {
+            if (slots[i].fd >= 0 && results[i] == -ECANCELED) {
+                close(slots[i].fd);
+            }
+        }
+        return -1;
+    }
+    
+    // 4. Parse; anything unusual (stale descriptor, short buffer) takes the sync path
+    for (int i = 0; i < n; i++) {
+        struct UringSlot *slot = &slots[i];
+        struct ProcessSample *sample = &samples[lo + i];
+        int pid = pids[lo + i];
+        
+        if (slot->len <= 0 || slot->len >= URING_STAT_BUF - 1) {
+            collectProcessSample(table, pid, sample);
+            continue;
+        }
+        
+        sample->pid = pid;
+        sample->flags = 0;
+        if (parseProcessStat(slot->buf, (size_t)slot->len, &sample->stat) == 0) {
+            sample->flags |= SAMPLE_OK;
+        }
+    }
+    return 0;
+}
+
+/**
+ * parseCollectBackend - Select the collection backend ("sync" or "uring")
+ * Returns: 0 on success, -1 if the name is unknown
+ */
+int parseCollectBackend(const char *name) {
+    if (strcmp(name, "sync") == 0) {
+        collectBackend = BACKEND_SYNC;
+    } else if (strcmp(name, "uring") == 0) {
+        collectBackend = BACKEND_URING;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * collectSampleRange - Collect samples[lo..hi) for pids[lo..hi)
+ */
+void collectSampleRange(const struct ProcessTable *table, const int *pids,
+                        struct ProcessSample *samples, int lo, int hi) {
+    int first = lo;
+    
+    if (collectBackend == BACKEND_URING && setupUring(&threadRing) == 0) {
+        for (int batch = lo; batch < hi; batch += URING_BATCH) {
+            int end = batch + URING_BATCH < hi ? batch + URING_BATCH : hi;
+            if (collectBatchUring(&threadRing, table, pids, samples, batch, end) != 0) {
+                // Ring broke mid-scan: finish synchronously and stop using it
+                closeUring(&threadRing);
+                threadRing.state = -1;
+                lo = batch;
+                break;
+            }
+            lo = end;
+        }
+    }
+    
+    for (int i = lo; i < hi; i++) {
+        collectProcessSample(table, pids[i], &samples[i]);
+    }
+    
+    if (SORT_BY_SWITCHES(processSort)) {
+        for (int i = first; i < hi; i++) {
+            collectProcessSwitches(table, &samples[i]);
+        }
+    }
+}
+
+// PIDs claimed by a worker at a time; small enough to balance slow shards
+#define SCAN_CHUNK 64
+
+/*
+ * Worker pool for parallel collection. The PID list is cut into chunks
+ * that workers (and the calling thread) claim with an atomic counter;
+ * each chunk writes only its own slice of the sample array.
+ */
+struct ScanPool {
+    pthread_t *threads;
+    int workers;                // Threads besides the caller
+    int requested;              // Total threads it was last started for (0: not started)
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    unsigned int job;           // Incremented for every scan handed out
+    int busy;                   // Workers still on the current job
+    int stopping;
+    
+    // Current job
+    const struct ProcessTable *table;
+    const int *pids;
+    struct ProcessSample *samples;
+    int count;
+    int next_chunk;
+};
+
+static struct ScanPool scanPool = {
+    NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    0, 0, 0, NULL, NULL, NULL, 0, 0
+};
+
+// Collection threads including the caller (-t, 0-SCAN_THREADS_MAX); 0 means one per online CPU
+static int scanThreads = 1;
+#define SCAN_THREADS_MAX 1024
+
+/**
+ * runScanChunks - Claim and collect chunks until the job is exhausted
+ */
+static void runScanChunks(struct ScanPool *pool) {
+    for (;;) {
+        int chunk = __atomic_fetch_add(&pool->next_chunk, 1, __ATOMIC_RELAXED);
+        int lo = chunk * SCAN_CHUNK;
+        if (lo >= pool->count) {
+            return;
+        }
+        int hi = lo + SCAN_CHUNK < pool->count ? lo + SCAN_CHUNK : pool->count;
+        collectSampleRange(pool->table, pool->pids, pool->samples, lo, hi);
+    }
+}
+
+/**
+ * scanWorker - Worker thread: wait for a job, collect chunks, report done
+ */
+static void *scanWorker(void *arg) {
+    struct ScanPool *pool = arg;
+    unsigned int done_job = 0;
+    
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->job == done_job && !pool->stopping) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+        done_job = pool->job;
+        pthread_mutex_unlock(&pool->lock);
+        
+        runScanChunks(pool);
+        
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    closeUring(&threadRing);
+    freeStatusBuffer();
+    return NULL;
+}
+
+/**
+ * stopScanPool - Stop and join all workers
+ */
+void stopScanPool(struct ScanPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    
+    for (int i = 0; i < pool->workers; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    free(pool->threads);
+    pool->threads = NULL;
+    pool->workers = 0;
+    pool->requested = 0;
+    pool->stopping = 0;
+    pool->job = 0;
+}
+
+/**
+ * startScanPool - Make the pool run with @threads collection threads in total
+ * Returns: 0 on success, -1 if no worker could be started (scan stays serial)
+ *
+ * A pool that came up short (pthread_create() failed partway) is kept
+ * as it is; it is only restarted when a different count is asked for.
+ */
+int startScanPool(struct ScanPool *pool, int threads) {
+    if (pool->requested == threads) {
+        return pool->workers > 0 ? 0 : -1;
+    }
+    stopScanPool(pool);
+    if (threads <= 1) {
+        return 0;
+    }
+    
+    pool->requested = threads;
+    pool->threads = malloc((size_t)(threads - 1) * sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        return -1;
+    }
+    
+    // Workers inherit the signal mask: block SIGINT/SIGTERM in them so
+    // the main thread is the one that sees Ctrl+C and leaves its loops
+    sigset_t block, saved;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &block, &saved);
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&pool->threads[i], NULL, scanWorker, pool) != 0) {
+            break;
+        }
+        pool->workers++;
+    }
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+    return pool->workers > 0 ? 0 : -1;
+}
+
+/**
+ * collectProcessSamples - Collect samples for all PIDs, in parallel if enabled
+ */
+void collectProcessSamples(const struct ProcessTable *table, const int *pids,
+                           struct ProcessSample *samples, int count) {
+    int threads = scanThreads;
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    
+    if (threads <= 1 || startScanPool(&scanPool, threads) != 0 || scanPool.workers == 0) {
+        collectSampleRange(table, pids, samples, 0, count);
+        return;
+    }
+    
+    struct ScanPool *pool = &scanPool;
+    pthread_mutex_lock(&pool->lock);
+    pool->table = table;
+    pool->pids = pids;
+    pool->samples = samples;
+    pool->count = count;
+    pool->next_chunk = 0;
+    pool->busy = pool->workers;
+    pool->job++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    
+    runScanChunks(pool);
+    
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * updateProcessTable - Scan /proc and update the process table in place
+ * @top: Selector fed with every live process, or NULL: (CPU%, total time, PID),
+ *       (RSS, virtual size, PID) when ranking by memory, or
+ *       (rate, cumulative count, PID) when ranking by faults or switches
+ * Returns: Number of processes in the table, or -1 if /proc cannot be read
+ *
+ * New processes are inserted, exited ones removed and existing entries
+ * updated in place. Names are only read when an entry is created.
+ * Candidates are offered by PID because removals move entries around.
+ */
+int updateProcessTable(struct ProcessTable *table, struct TopK *top) {
+    int pid_count = enumeratePids(&procEnumerator);
+    if (pid_count < 0) {
+        return -1;
+    }
+    
+    if (pid_count > table->samples_capacity) {
+        struct ProcessSample *samples = realloc(table->samples, (size_t)procEnumerator.capacity * sizeof(*samples));
+        if (samples == NULL) {
+            return -1;
+        }
+        table->samples = samples;
+        table->samples_capacity = (int)procEnumerator.capacity;
+    }
+    
+    // CLOCK_BOOTTIME shares its origin with stat starttime
+    struct timespec now_ts;
+    clock_gettime(CLOCK_BOOTTIME, &now_ts);
+    double now = now_ts.tv_sec + now_ts.tv_nsec / 1e9;
+    double previous_scan = table->scanned_at;
+    table->elapsed = previous_scan > 0 ? now - previous_scan : 0.0;
+    table->scanned_at = now;
+    
+    static long clk_tck = 0;
+    if (clk_tck == 0) {
+        clk_tck = sysconf(_SC_CLK_TCK);
+    }
+    double scale = 100.0;
+    if (procCpuNormalize == NORMALIZE_MACHINE) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        scale /= cpus > 0 ? cpus : 1;
+    }
+    unsigned long long previous_scan_ticks = (unsigned long long)(previous_scan * clk_tck);
+    
+    collectProcessSamples(table, procEnumerator.pids, table->samples, pid_count);
+    
+    // Merge: apply all samples to the table on this thread
+    table->generation++;
+    
+    for (int p = 0; p < pid_count; p++) {
+        const struct ProcessSample *sample = &table->samples[p];
+        const struct ProcessStat *stat = &sample->stat;
+        int pid = sample->pid;
+        struct ProcessInfo *proc = findProcess(table, pid);
+        
+        if (proc != NULL && (sample->flags & SAMPLE_FD_STALE) && proc->dir_fd != -1) {
+            close(proc->dir_fd);
+            proc->dir_fd = -1;
+        }
+        if (!(sample->flags & SAMPLE_OK)) {
+            continue;
+        }
+        
+        // Same PID, different start time: the PID was reused by a new process
+        if (proc != NULL && proc->starttime != stat->field[PSTAT_STARTTIME]) {
+            removeProcess(table, (int)(proc - table->entries));
+            proc = NULL;
+        }
+        
+        int is_new = 0;
+        if (proc == NULL) {
+            proc = insertProcess(table, pid);
+            if (proc == NULL) {
+                continue; // Out of memory, skip this process
+            }
+            is_new = 1;
+            proc->starttime = stat->field[PSTAT_STARTTIME];
+        }
+        
+        // stat always carries the current name, so exec() renames show up
+        memcpy(proc->name, stat->name, sizeof(proc->name));
+        
+        // Ticks used during this interval. A new process only has a rate if
+        // it started after the previous scan (all its ticks are then recent).
+        unsigned long total = (unsigned long)(stat->field[PSTAT_UTIME] + stat->field[PSTAT_STIME]);
+        unsigned long delta = total >= proc->total_time ? total - proc->total_time : 0;
+        int has_rate = table->elapsed > 0 && (!is_new || proc->starttime >= previous_scan_ticks);
+        proc->cpu_percent = has_rate ? scale * delta / clk_tck / table->elapsed : 0.0;
+        
+        // Fault and switch rates over the same interval; the counters never go backwards
+        unsigned long long minflt = stat->field[PSTAT_MINFLT];
+        unsigned long long majflt = stat->field[PSTAT_MAJFLT];
+        proc->minflt_rate = has_rate && minflt >= proc->minflt ? (minflt - proc->minflt) / table->elapsed : 0.0;
+        proc->majflt_rate = has_rate && majflt >= proc->majflt ? (majflt - proc->majflt) / table->elapsed : 0.0;
+        int switches = (sample->flags & SAMPLE_SWITCHES) != 0;
+        if (switches && has_rate && (is_new || proc->has_switches) &&
+            sample->nvcsw >= proc->nvcsw && sample->nivcsw >= proc->nivcsw) {
+            proc->nvcsw_rate = (sample->nvcsw - proc->nvcsw) / table->elapsed;
+            proc->nivcsw_rate = (sample->nivcsw - proc->nivcsw) / table->elapsed;
+        } else {
+            proc->nvcsw_rate = proc->nivcsw_rate = 0.0;
+        }
+        proc->has_switches = switches;
+        proc->nvcsw = switches ? sample->nvcsw : 0;
+        proc->nivcsw = switches ? sample->nivcsw : 0;
+        
+        proc->utime = (unsigned long)stat->field[PSTAT_UTIME];
+        proc->stime = (unsigned long)stat->field[PSTAT_STIME];
+        proc->total_time = total;
+        proc->state = stat->state;
+        proc->ppid = (int)stat->field[PSTAT_PPID];
+        proc->num_threads = (long)stat->field[PSTAT_NUM_THREADS];
+        proc->minflt = minflt;
+        proc->majflt = majflt;
+        proc->vsize = stat->field[PSTAT_VSIZE];
+        proc->rss = stat->field[PSTAT_RSS];
+        proc->rollup = 0;
+        proc->cmdline = proc->user = proc->cgroup = 0; // detailPool is refilled for displayed rows only
+        proc->seen = table->generation;
+        
+        if (top == NULL) {
+            continue;
+        }
+        switch (processSort) {
+        case SORT_CPU:
+            offerTopK(top, proc->cpu_percent, proc->total_time, pid);
+            break;
+        case SORT_MEM:
+        case SORT_PSS:
+            offerTopK(top, (double)proc->rss, proc->vsize, pid);
+            break;
+        case SORT_MINFLT:
+            offerTopK(top, proc->minflt_rate, proc->minflt, pid);
+            break;
+        case SORT_MAJFLT:
+            offerTopK(top, proc->majflt_rate, proc->majflt, pid);
+            break;
+        case SORT_CSWCH:
+            offerTopK(top, proc->nvcsw_rate, proc->nvcsw, pid);
+            break;
+        case SORT_NVCSWCH:
+            offerTopK(top, proc->nivcsw_rate, proc->nivcsw, pid);
+            break;
+        }
+    }
+    
+    // Drop processes that were not seen in this scan (they have exited)
+    for (int i = table->count - 1; i >= 0; i--) {
+        if (table->entries[i].seen != table->generation) {
+            removeProcess(table, i);
+        }
+    }
+    
+    return table->count;
+}
+
+/**
+ * rerankByPss - Re-rank RSS-preselected candidates by PSS from smaps_rollup
+ * @top: Finished selector holding the candidates; refilled with the best k
+ * Returns: Number of entries in top->heap, best first
+ *
+ * A candidate whose rollup cannot be read (e.g. another user's process
+ * without privileges) is ranked by its RSS instead.
+ */
+int rerankByPss(struct ProcessTable *table, struct TopK *top, int k) {
+    int candidates = top->size < PSS_CANDIDATES(TOP_COUNT_MAX) ? top->size : PSS_CANDIDATES(TOP_COUNT_MAX);
+    int pids[PSS_CANDIDATES(TOP_COUNT_MAX)];
+    long page_kb = pageKilobytes();
+    
+    for (int i = 0; i < candidates; i++) {
+        pids[i] = top->heap[i].id;
+    }
+    resetTopK(top, k); // k never exceeds the candidate capacity
+    
+    for (int i = 0; i < candidates; i++) {
+        struct ProcessInfo *proc = findProcess(table, pids[i]);
+        if (proc == NULL) {
+            continue;
+        }
+        proc->rollup = readProcessRollup(proc->pid, proc->dir_fd, &proc->pss, &proc->swap) == 0;
+        double key = proc->rollup ? (double)proc->pss : (double)(proc->rss * page_kb);
+        offerTopK(top, key, proc->rss, proc->pid);
+    }
+    return finishTopK(top);
+}
+
+/**
+ * listTopProcesses - Display the top processes by CPU or memory (5 by default, -k, -s)
+ */
+void listTopProcesses() {
+    int by_memory = SORT_BY_MEMORY(processSort);
+    int by_activity = processSort != SORT_CPU && !by_memory; // Fault or switch rates
+    int candidates = processSort == SORT_PSS ? PSS_CANDIDATES(topCount) : topCount;
+    static const char *const activity_titles[] = {
+        [SORT_MINFLT] = "Minor Faults", [SORT_MAJFLT] = "Major Faults",
+        [SORT_CSWCH] = "Voluntary Context Switches", [SORT_NVCSWCH] = "Involuntary Context Switches"
+    };
+    
+    if (by_memory) {
+        emit("\n=== Top %d Processes by Memory (%s) ===\n", topCount, processSort == SORT_PSS ? "PSS" : "RSS");
+    } else if (by_activity) {
+        emit("\n=== Top %d Processes by %s ===\n", topCount, activity_titles[processSort]);
+    } else {
+        emit("\n=== Top %d Active Processes ===\n", topCount);
+    }
+    
+    if (resetTopK(&processRanking, candidates) != 0) {
+        reportError("Error: Out of memory for process ranking\n");
+        return;
+    }
+    int process_count = updateProcessTable(&processTable, &processRanking);
+    
+    // Rates need an interval: take a second scan shortly after the first one
+    if (process_count >= 0 && processTable.elapsed == 0 && !by_memory) {
+        struct timespec delay = { 0, PROC_FIRST_SAMPLE_MS * 1000000L };
+        nanosleep(&delay, NULL);
+        resetTopK(&processRanking, candidates);
+        process_count = updateProcessTable(&processTable, &processRanking);
+    }
+    
+    if (process_count < 0) {
+        reportErrno("Error: Failed to read /proc directory");
+        writeLog("Error: Failed to read /proc directory");
+        return;
+    }
+    
+    if (process_count == 0) {
+        emit("No processes found.\n\n");
+        writeLog("No processes found");
+        return;
+    }
+    
+    // Resolve the selected PIDs, highest ranked first
+    int display_count = finishTopK(&processRanking);
+    if (processSort == SORT_PSS) {
+        display_count = rerankByPss(&processTable, &processRanking, topCount);
+    }
+    if (display_count == 0) {
+        emit("No processes found.\n\n");
+        return;
+    }
+    if (display_count > rankedCapacity) {
+        struct ProcessInfo **grown = realloc(rankedProcesses, (size_t)display_count * sizeof(*grown));
+        if (grown == NULL) {
+            reportError("Error: Out of memory for process ranking\n");
+            return;
+        }
+        rankedProcesses = grown;
+        rankedCapacity = display_count;
+    }
+    struct ProcessInfo **ranked = rankedProcesses;
+    for (int i = 0; i < display_count; i++) {
+        ranked[i] = findProcess(&processTable, processRanking.heap[i].id);
+    }
+    
+    // Keep /proc/[PID] descriptors for the displayed processes and
+    // fetch their details through them
+    trackProcesses(&processTable, ranked, display_count);
+    fetchProcessDetails(ranked, display_count);
+    
+    // Display header
+    const char *cpu_header = procCpuNormalize == NORMALIZE_MACHINE ? "CPU % (all)" : "CPU % (core)";
+    if (by_memory) {
+        emit("%-8s %-10s %-24s %10s %10s %10s  %-13s %s\n", "PID", "User", "Process Name",
+               "RSS (MB)", "PSS (MB)", "Swap (MB)", cpu_header, "Command");
+    } else if (by_activity) {
+        emit("%-8s %-10s %-24s %10s %10s %10s %10s  %-13s %s\n", "PID", "User", "Process Name",
+               "minflt/s", "majflt/s", "cswch/s", "nvcswch/s", cpu_header, "Command");
+    } else {
+        emit("%-8s %-10s %-24s %-12s %-13s %-24s %s\n", "PID", "User", "Process Name", "CPU Time",
+               cpu_header, "Cgroup", "Command");
+    }
+    emit("==============================================================================================================\n");
+    
+    // Rows go through the fixed formatters; this loop is most of a frame
+    double format_start = monotonicMicros();
+    long page_kb = pageKilobytes();
+    for (int i = 0; i < display_count; i++) {
+        const struct ProcessInfo *proc = ranked[i];
+        const char *user = poolString(&detailPool, proc->user);
+        const char *cmdline = poolString(&detailPool, proc->cmdline);
+        
+        emitSigned(proc->pid, -8);
+        emitText(" ", 1);
+        emitPadded(user ? user : "-", -10);
+        emitText(" ", 1);
+        emitPadded(proc->name, -24);
+        emitText(" ", 1);
+        if (by_memory) {
+            // A single memory scan has no interval to measure CPU% over
+            emitFixed(proc->rss * page_kb / 1024.0, 1, 10);
+            emitText(" ", 1);
+            if (proc->rollup) {
+                emitFixed(proc->pss / 1024.0, 1, 10);
+                emitText(" ", 1);
+                emitFixed(proc->swap / 1024.0, 1, 10);
+            } else {
+                emitString("         -          -");
+            }
+            if (processTable.elapsed > 0) {
+                emitText("  ", 2);
+                emitFixed(proc->cpu_percent, 2, 7);
+                emitText("%", 1);
+            } else {
+                emitString("         -");
+            }
+        } else if (by_activity) {
+            // Switch counts come from status, which is only read for the switch sorts
+            emitFixed(proc->minflt_rate, 1, 10);
+            emitText(" ", 1);
+            emitFixed(proc->majflt_rate, 1, 10);
+            emitText(" ", 1);
+            if (proc->has_switches) {
+                emitFixed(proc->nvcsw_rate, 1, 10);
+                emitText(" ", 1);
+                emitFixed(proc->nivcsw_rate, 1, 10);
+            } else {
+                emitString("         -          -");
+            }
+            emitText("  ", 2);
+            emitFixed(proc->cpu_percent, 2, 7);
+            emitText("%", 1);
+        } else {
+            const char *cgroup = poolString(&detailPool, proc->cgroup);
+            emitUnsigned(proc->total_time, -12);
+            emitText(" ", 1);
+            emitFixed(proc->cpu_percent, 2, 7);
+            emitString("%      ");
+            emitPadded(cgroup ? cgroup : "-", -24);
+        }
+        
+        const char *command = cmdline ? cmdline : "-";
+        emitString(by_memory || by_activity ? "      " : " ");
+        emitClipped(command, 40);
+        emitText("\n", 1);
+    }
+    emitText("\n", 1);
+    stopFormatTimer(format_start);
+    
+    // Log the results
+    char log_msg[512];
+    if (by_memory) {
+        snprintf(log_msg, sizeof(log_msg),
+                 "Top %d processes by memory displayed: Top process PID=%d (%s) RSS %.1f MB",
+                 display_count, ranked[0]->pid, ranked[0]->name, ranked[0]->rss * page_kb / 1024.0);
+    } else if (by_activity) {
+        snprintf(log_msg, sizeof(log_msg),
+                 "Top %d processes by %s displayed: Top process PID=%d (%s) at %.1f/s",
+                 display_count, activity_titles[processSort], ranked[0]->pid, ranked[0]->name,
+                 processRanking.heap[0].key);
+    } else {
+        snprintf(log_msg, sizeof(log_msg), 
+                 "Top %d processes displayed: Top process PID=%d (%s) at %.2f%% CPU",
+                 display_count, ranked[0]->pid, ranked[0]->name, ranked[0]->cpu_percent);
+    }
+    writeLog(log_msg);
+}
+
+// ==================== CGROUP MODULE ====================
+
+/*
+ * Cgroup Module
+ * - Walks the cgroup v2 hierarchy once and caches it as a flat array
+ *   (parents before children). Later ticks re-list a directory's
+ *   children only when its inode, link count or mtime changed (a child
+ *   was created or removed), or when its cgroup.events went from
+ *   "populated 0" to "populated 1"
+ * - Subtrees with "populated 0" hold no tasks and are not sampled
+ * - Per cgroup: CPU from cpu.stat, memory from memory.current and
+ *   memory.stat, I/O from io.stat (summed over devices) and stall time
+ *   from the {cpu,memory,io}.pressure totals, as rates over the tick
+ * - Files of controllers not enabled for a cgroup are simply absent; on
+ *   hosts without a cgroup2 mount (cgroup v1 only) the view says so
+ */
+
+// Cumulative counters sampled per cgroup
+enum CgroupField {
+    CG_CPU_USAGE, CG_CPU_USER, CG_CPU_SYSTEM, CG_CPU_THROTTLED,     // cpu.stat, usec
+    CG_IO_RBYTES, CG_IO_WBYTES, CG_IO_RIOS, CG_IO_WIOS,             // io.stat, all devices
+    CG_MEM_PGFAULT, CG_MEM_PGMAJFAULT,                              // memory.stat
+    CG_CPU_SOME, CG_MEM_SOME, CG_MEM_FULL, CG_IO_SOME, CG_IO_FULL,  // *.pressure totals, usec
+    CG_FIELDS
+};
+
+// Which files could be read in the latest sample
+#define CG_HAS_CPU 0x1      // cpu.stat
+#define CG_HAS_MEM 0x2      // memory.current and memory.stat
+#define CG_HAS_IO  0x4      // io.stat
+#define CG_HAS_PSI 0x8      // {cpu,memory,io}.pressure
+
+#define CGROUP_PATH_MAX 4096
+
+struct CgroupNode {
+    char *path;                 // Relative to the mount, "" for the root
+    int parent;                 // Index of the parent, -1 for the root
+    int alive;                  // Cleared when the directory disappears
+    int populated;              // cgroup.events "populated" (the root always is)
+    int scanned;                // Children listed at least once
+    int mark;                   // Scratch flag for scanCgroupChildren()
+    ino_t ino;                  // Directory signature at the last child listing
+    nlink_t nlink;
+    struct timespec mtime;
+    unsigned int present;       // CG_HAS_* of the latest sample
+    int has_prev;
+    int valid;                  // delta covers a full interval
+    unsigned long long curr[CG_FIELDS];
+    unsigned long long prev[CG_FIELDS];
+    unsigned long long delta[CG_FIELDS];
+    unsigned long long mem_current;     // Bytes
+    unsigned long long mem_anon;
+    unsigned long long mem_file;
+};
+
+// Cached hierarchy plus sampling state, like struct DiskSampler
+struct CgroupTree {
+    char *mount;                // cgroup2 mount point
+    int root_fd;                // Held descriptor on the mount point
+    struct CgroupNode *nodes;   // Parents always precede their children
+    int count;
+    int capacity;
+    int relisted;               // Directories re-listed by the latest sample
+    struct timespec taken;      // CLOCK_MONOTONIC time of the latest sample
+    double elapsed;             // Seconds covered by the current deltas
+    char *buf;                  // Read buffer shared by every cgroup file
+    size_t cap;
+};
+
+// Tree behind listTopCgroups(), created on first use
+static struct CgroupTree *cgroupDisplayTree = NULL;
+
+// Set once no cgroup2 mount was found, so mountinfo is not re-read every tick
+static int cgroupV2Missing = 0;
+
+// Ranking of the current sample, fed with node indices
+static struct TopK cgroupRanking;
+
+/**
+ * findCgroupMount - Find the cgroup2 mount point in /proc/self/mountinfo
+ * @out: Receives the mount point (prefers /sys/fs/cgroup over a hybrid
+ *       layout's /sys/fs/cgroup/unified)
+ * Returns: 0 on success, -1 if cgroup v2 is not mounted
+ */
+int findCgroupMount(char *out, size_t size) {
+    struct ProcSource mountinfo = PROC_SOURCE_INIT("/proc/self/mountinfo");
+    struct ProcCursor cur;
+    int found = -1;
+    
+    ssize_t len = readProcSource(&mountinfo);
+    if (len == -1) {
+        closeProcSource(&mountinfo);
+        return -1;
+    }
+    
+    // "36 35 98:0 / /sys/fs/cgroup rw,relatime shared:5 - cgroup2 cgroup2 rw"
+    initCursor(&cur, mountinfo.buf, (size_t)len);
+    while (cur.p < cur.end) {
+        const char *line_end = memchr(cur.p, '\n', (size_t)(cur.end - cur.p));
+        if (line_end == NULL) {
+            line_end = cur.end;
+        }
+        const char *field[6] = { NULL };
+        size_t field_len[6] = { 0 };
+        int fields = 0, after_separator = 0;
+        
+        while (cur.p < line_end) {
+            skipBlanks(&cur);
+            const char *start = cur.p;
+            while (cur.p < line_end && *cur.p != ' ') {
+                cur.p++;
+            }
+            size_t n = (size_t)(cur.p - start);
+            if (n == 0) {
+                break;
+            }
+            if (after_separator) {
+                field[5] = start;       // Filesystem type
+                field_len[5] = n;
+                break;
+            }
+            if (n == 1 && *start == '-') {
+                after_separator = 1;
+            } else if (fields < 5) {
+                field[fields] = start;
+                field_len[fields] = n;
+                fields++;
+            }
+        }
+        
+        if (fields == 5 && field[5] != NULL && field_len[5] == 7 && memcmp(field[5], "cgroup2", 7) == 0 &&
+            field_len[4] < size) {
+            int preferred = field_len[4] == 14 && memcmp(field[4], "/sys/fs/cgroup", 14) == 0;
+            if (found == -1 || preferred) {
+                memcpy(out, field[4], field_len[4]);
+                out[field_len[4]] = '\0';
+                found = 0;
+            }
+            if (preferred) {
+                break;
+            }
+        }
+        cur.p = line_end;
+        skipLine(&cur);
+    }
+    
+    closeProcSource(&mountinfo);
+    return found;
+}
+
+/**
+ * cgroupDir - Path of a node for the *at() calls on the mount descriptor
+ */
+static inline const char *cgroupDir(const struct CgroupNode *node) {
+    return node->path[0] ? node->path : ".";
+}
+
+/**
+ * readCgroupFile - Read a whole interface file of a cgroup into tree->buf
+ * Returns: Number of bytes read (NUL-terminated), or -1 with errno set
+ */
+ssize_t readCgroupFile(struct CgroupTree *tree, const struct CgroupNode *node, const char *file) {
+    char path[CGROUP_PATH_MAX];
+    size_t used = 0;
+    
+    if (snprintf(path, sizeof(path), "%s/%s", cgroupDir(node), file) >= (int)sizeof(path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    int fd = openat(tree->root_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    
+    for (;;) {
+        if (used + 1 >= tree->cap) {
+            size_t cap = tree->cap ? tree->cap * 2 : PROC_SOURCE_MIN_BUF;
+            char *grown = realloc(tree->buf, cap);
+            if (grown == NULL) {
+                close(fd);
+                errno = ENOMEM;
+                return -1;
+            }
+            tree->buf = grown;
+            tree->cap = cap;
+        }
+        ssize_t n = read(fd, tree->buf + used, tree->cap - 1 - used);
+        if (n == -1) {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        used += (size_t)n;
+    }
+    
+    close(fd);
+    tree->buf[used] = '\0';
+    return (ssize_t)used;
+}
+
+/**
+ * addCgroupNode - Append a node for path (taking ownership of it)
+ * Returns: Index of the new node, or -1 on allocation failure
+ */
+static int addCgroupNode(struct CgroupTree *tree, char *path, int parent) {
+    if (tree->count == tree->capacity) {
+        int capacity = tree->capacity ? tree->capacity * 2 : 64;
+        struct CgroupNode *nodes = realloc(tree->nodes, (size_t)capacity * sizeof(*nodes));
+        if (nodes == NULL) {
+            return -1;
+        }
+        tree->nodes = nodes;
+        tree->capacity = capacity;
+    }
+    
+    struct CgroupNode *node = &tree->nodes[tree->count];
+    memset(node, 0, sizeof(*node));
+    node->path = path;
+    node->parent = parent;
+    node->alive = 1;
+    node->populated = parent == -1;
+    return tree->count++;
+}
+
+/**
+ * scanCgroupChildren - List a cgroup directory and sync its cached children
+ * Returns: 0 on success, -1 if the directory cannot be read
+ *
+ * New subdirectories are appended (and listed in turn later in the same
+ * sample); children that are gone are marked dead.
+ */
+static int scanCgroupChildren(struct CgroupTree *tree, int index) {
+    int dir_fd = openat(tree->root_fd, cgroupDir(&tree->nodes[index]), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd == -1) {
+        return -1;
+    }
+    DIR *dir = fdopendir(dir_fd);
+    if (dir == NULL) {
+        close(dir_fd);
+        return -1;
+    }
+    
+    int first_child = tree->count;
+    for (int i = index + 1; i < tree->count; i++) {
+        if (tree->nodes[i].parent == index) {
+            tree->nodes[i].mark = 0;
+            if (i < first_child) {
+                first_child = i;
+            }
+        }
+    }
+    
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue; // ".", ".." (cgroup names cannot start with a dot)
+        }
+        if (entry->d_type != DT_DIR) {
+            struct stat st;
+            if (entry->d_type != DT_UNKNOWN || fstatat(dirfd(dir), entry->d_name, &st, 0) != 0 ||
+                !S_ISDIR(st.st_mode)) {
+                continue;
+            }
+        }
+        
+        const char *parent_path = tree->nodes[index].path;
+        char path[CGROUP_PATH_MAX];
+        int len = snprintf(path, sizeof(path), "%s%s%s", parent_path, parent_path[0] ? "/" : "", entry->d_name);
+        if (len >= (int)sizeof(path)) {
+            continue;
+        }
+        
+        int known = 0;
+        for (int i = first_child; i < tree->count && !known; i++) {
+            struct CgroupNode *child = &tree->nodes[i];
+            if (child->parent == index && child->alive && strcmp(child->path, path) == 0) {
+                child->mark = 1;
+                known = 1;
+            }
+        }
+        if (known) {
+            continue;
+        }
+        
+        char *copy = strdup(path);
+        int added = copy ? addCgroupNode(tree, copy, index) : -1;
+        if (added == -1) {
+            free(copy);
+            continue; // Out of memory, try again on the next listing
+        }
+        tree->nodes[added].mark = 1;
+    }
+    closedir(dir);
+    
+    for (int i = first_child; i < tree->count; i++) {
+        if (tree->nodes[i].parent == index && !tree->nodes[i].mark) {
+            tree->nodes[i].alive = 0; // Its descendants follow when it is skipped
+        }
+    }
+    return 0;
+}
+
+/**
+ * readCgroupPopulated - Read "populated" from a cgroup's cgroup.events
+ * Returns: 0 or 1, or -1 if the file cannot be read
+ */
+static int readCgroupPopulated(struct CgroupTree *tree, const struct CgroupNode *node) {
+    struct ProcCursor cur;
+    unsigned long long value;
+    
+    ssize_t len = readCgroupFile(tree, node, "cgroup.events");
+    if (len == -1) {
+        return -1;
+    }
+    initCursor(&cur, tree->buf, (size_t)len);
+    do {
+        if (matchPrefix(&cur, "populated", 9) && parseUnsigned(&cur, &value) == 0) {
+            return value != 0;
+        }
+    } while (skipLine(&cur));
+    return 1; // Unknown format: assume tasks so the cgroup is still sampled
+}
+
+/**
+ * parseCgroupKeyed - Parse "key value" lines, storing the listed keys
+ * @keys: NULL-terminated names; values[i] receives the value of keys[i]
+ */
+static void parseCgroupKeyed(const char *buffer, size_t len, const char *const *keys, unsigned long long **values) {
+    struct ProcCursor cur;
+    
+    initCursor(&cur, buffer, len);
+    while (cur.p < cur.end) {
+        for (int k = 0; keys[k] != NULL; k++) {
+            size_t key_len = strlen(keys[k]);
+            struct ProcCursor at = cur;
+            if (matchPrefix(&at, keys[k], key_len) && at.p < at.end && *at.p == ' ') {
+                parseUnsigned(&at, values[k]);
+                break;
+            }
+        }
+        skipLine(&cur);
+    }
+}
+
+/**
+ * parseCgroupIoStat - Sum io.stat byte and operation counters over all devices
+ *
+ * Lines look like "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0".
+ */
+static void parseCgroupIoStat(const char *buffer, size_t len, unsigned long long *field) {
+    static const struct { const char *key; size_t len; int field; } keys[] = {
+        { "rbytes=", 7, CG_IO_RBYTES }, { "wbytes=", 7, CG_IO_WBYTES },
+        { "rios=", 5, CG_IO_RIOS }, { "wios=", 5, CG_IO_WIOS },
+    };
+    struct ProcCursor cur;
+    
+    initCursor(&cur, buffer, len);
+    while (cur.p < cur.end) {
+        const char *line_end = memchr(cur.p, '\n', (size_t)(cur.end - cur.p));
+        struct ProcCursor line = { cur.p, line_end ? line_end : cur.end };
+        
+        while (line.p < line.end && *line.p != ' ') {
+            line.p++; // Device "maj:min"
+        }
+        while (line.p < line.end) {
+            skipBlanks(&line);
+            int matched = 0;
+            for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]) && !matched; k++) {
+                unsigned long long value;
+                if (matchPrefix(&line, keys[k].key, keys[k].len) && parseUnsigned(&line, &value) == 0) {
+                    field[keys[k].field] += value;
+                    matched = 1;
+                }
+            }
+            while (line.p < line.end && *line.p != ' ') {
+                line.p++; // Unused key (dbytes, dios, ...) or the rest of a bad value
+            }
+        }
+        cur.p = line.end;
+        skipLine(&cur);
+    }
+}
+
+/**
+ * readCgroupStats - Read the interface files of one cgroup into curr
+ * Returns: CG_HAS_* mask of the files that could be read
+ */
+static unsigned int readCgroupStats(struct CgroupTree *tree, struct CgroupNode *node) {
+    static const char *const cpu_keys[] = { "usage_usec", "user_usec", "system_usec", "throttled_usec", NULL };
+    static const char *const mem_keys[] = { "anon", "file", "pgfault", "pgmajfault", NULL };
+    unsigned int present = 0;
+    struct ProcCursor cur;
+    ssize_t len;
+    
+    memset(node->curr, 0, sizeof(node->curr));
+    
+    if ((len = readCgroupFile(tree, node, "cpu.stat")) != -1) {
+        unsigned long long *cpu_values[] = {
+            &node->curr[CG_CPU_USAGE], &node->curr[CG_CPU_USER],
+            &node->curr[CG_CPU_SYSTEM], &node->curr[CG_CPU_THROTTLED]
+        };
+        parseCgroupKeyed(tree->buf, (size_t)len, cpu_keys, cpu_values);
+        present |= CG_HAS_CPU;
+    }
+    
+    node->mem_current = node->mem_anon = node->mem_file = 0;
+    if ((len = readCgroupFile(tree, node, "memory.current")) != -1) {
+        initCursor(&cur, tree->buf, (size_t)len);
+        parseUnsigned(&cur, &node->mem_current);
+        if ((len = readCgroupFile(tree, node, "memory.stat")) != -1) {
+            unsigned long long *mem_values[] = {
+                &node->mem_anon, &node->mem_file,
+                &node->curr[CG_MEM_PGFAULT], &node->curr[CG_MEM_PGMAJFAULT]
+            };
+            parseCgroupKeyed(tree->buf, (size_t)len, mem_keys, mem_values);
+        }
+        present |= CG_HAS_MEM;
+    }
+    
+    if ((len = readCgroupFile(tree, node, "io.stat")) != -1) {
+        parseCgroupIoStat(tree->buf, (size_t)len, node->curr);
+        present |= CG_HAS_IO;
+    }
+    
+    // Same format as /proc/pressure; the totals give the stall share of this tick
+    static const struct { const char *file; int some; int full; } pressure[] = {
+        { "cpu.pressure", CG_CPU_SOME, -1 },
+        { "memory.pressure", CG_MEM_SOME, CG_MEM_FULL },
+        { "io.pressure", CG_IO_SOME, CG_IO_FULL },
+    };
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        struct PressureStats stats;
+        if ((len = readCgroupFile(tree, node, pressure[r].file)) == -1 ||
+            parsePressure(tree->buf, (size_t)len, &stats) != 0) {
+            continue;
+        }
+        node->curr[pressure[r].some] = stats.some_total;
+        if (pressure[r].full >= 0) {
+            node->curr[pressure[r].full] = stats.full_total;
+        }
+        present |= CG_HAS_PSI;
+    }
+    return present;
+}
+
+/**
+ * compactCgroupTree - Drop dead nodes, keeping parents before children
+ */
+static void compactCgroupTree(struct CgroupTree *tree) {
+    int dead = 0;
+    for (int i = 0; i < tree->count; i++) {
+        dead += !tree->nodes[i].alive;
+    }
+    if (dead == 0) {
+        return;
+    }
+    
+    int *remap = malloc((size_t)tree->count * sizeof(*remap));
+    if (remap == NULL) {
+        return; // Retried on the next sample
+    }
+    int kept = 0;
+    for (int i = 0; i < tree->count; i++) {
+        struct CgroupNode *node = &tree->nodes[i];
+        if (!node->alive) {
+            free(node->path);
+            remap[i] = -1;
+            continue;
+        }
+        remap[i] = kept;
+        if (node->parent >= 0) {
+            node->parent = remap[node->parent];
+        }
+        tree->nodes[kept++] = *node;
+    }
+    tree->count = kept;
+    free(remap);
+}
+
+/**
+ * createCgroupTree - Open the cgroup2 mount and set up an empty tree
+ * Returns: New tree, or NULL (errno ENOENT if cgroup v2 is not mounted)
+ */
+struct CgroupTree *createCgroupTree() {
+    char mount[CGROUP_PATH_MAX];
+    
+    if (findCgroupMount(mount, sizeof(mount)) != 0) {
+        errno = ENOENT;
+        return NULL;
+    }
+    struct CgroupTree *tree = calloc(1, sizeof(*tree));
+    if (tree == NULL) {
+        return NULL;
+    }
+    tree->root_fd = open(mount, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    tree->mount = strdup(mount);
+    char *root_path = strdup("");
+    if (tree->root_fd == -1 || tree->mount == NULL || root_path == NULL ||
+        addCgroupNode(tree, root_path, -1) != 0) {
+        int saved = errno;
+        if (tree->root_fd != -1) {
+            close(tree->root_fd);
+        }
+        free(root_path);
+        free(tree->mount);
+        free(tree->nodes);
+        free(tree);
+        errno = saved;
+        return NULL;
+    }
+    return tree;
+}
+
+/**
+ * sampleCgroups - Refresh the cached tree and sample every populated cgroup
+ * Returns: Number of live cgroups, or -1 if the hierarchy cannot be read
+ */
+int sampleCgroups(struct CgroupTree *tree) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    tree->elapsed = tree->taken.tv_sec || tree->taken.tv_nsec ?
+                    (now.tv_sec - tree->taken.tv_sec) + (now.tv_nsec - tree->taken.tv_nsec) / 1e9 : 0.0;
+    tree->taken = now;
+    tree->relisted = 0;
+    
+    // Parents precede children, so a node's parent is already up to date
+    for (int i = 0; i < tree->count; i++) {
+        struct CgroupNode *node = &tree->nodes[i];
+        int parent = node->parent;
+        
+        if (!node->alive) {
+            continue;
+        }
+        if (parent >= 0 && !tree->nodes[parent].alive) {
+            node->alive = 0;
+            continue;
+        }
+        if (parent >= 0 && !tree->nodes[parent].populated) {
+            node->populated = 0;
+            node->has_prev = node->valid = 0;
+            continue;
+        }
+        
+        int was_populated = node->populated;
+        if (parent >= 0) {
+            int populated = readCgroupPopulated(tree, node);
+            if (populated == -1 && errno == ENOENT) {
+                node->alive = 0;
+                continue;
+            }
+            node->populated = populated != 0;
+        }
+        
+        struct stat st;
+        if (fstatat(tree->root_fd, cgroupDir(node), &st, 0) != 0) {
+            if (parent == -1) {
+                return -1;
+            }
+            node->alive = 0;
+            continue;
+        }
+        if (node->scanned && st.st_ino != node->ino) {
+            node->has_prev = 0; // Removed and re-created between samples
+        }
+        if (!node->scanned || st.st_ino != node->ino || st.st_nlink != node->nlink ||
+            st.st_mtim.tv_sec != node->mtime.tv_sec || st.st_mtim.tv_nsec != node->mtime.tv_nsec ||
+            (node->populated && !was_populated)) {
+            node->ino = st.st_ino;
+            node->nlink = st.st_nlink;
+            node->mtime = st.st_mtim;
+            node->scanned = 1;
+            if (scanCgroupChildren(tree, i) == 0) {
+                tree->relisted++;
+            }
+            node = &tree->nodes[i]; // The array may have grown
+        }
+        
+        if (!node->populated) {
+            node->has_prev = node->valid = 0;
+            continue;
+        }
+        
+        unsigned int present = readCgroupStats(tree, node);
+        int valid = node->has_prev && present == node->present && tree->elapsed > 0;
+        for (int f = 0; f < CG_FIELDS; f++) {
+            if (node->curr[f] < node->prev[f]) {
+                valid = 0;
+            }
+            node->delta[f] = node->curr[f] - node->prev[f];
+        }
+        node->valid = valid;
+        node->has_prev = 1;
+        node->present = present;
+        memcpy(node->prev, node->curr, sizeof(node->prev));
+    }
+    
+    compactCgroupTree(tree);
+    return tree->count;
+}
+
+/**
+ * getCgroupRate - Per-second rate of one counter over the last interval
+ * Returns: Rate, or -1.0 if the cgroup has no full interval
+ */
+double getCgroupRate(const struct CgroupTree *tree, const struct CgroupNode *node, enum CgroupField field) {
+    if (!node->valid || tree->elapsed <= 0) {
+        return -1.0;
+    }
+    return node->delta[field] / tree->elapsed;
+}
+
+/**
+ * destroyCgroupTree - Release a tree and its descriptor
+ */
+void destroyCgroupTree(struct CgroupTree *tree) {
+    if (tree == NULL) {
+        return;
+    }
+    for (int i = 0; i < tree->count; i++) {
+        free(tree->nodes[i].path);
+    }
+    if (tree->root_fd != -1) {
+        close(tree->root_fd);
+    }
+    free(tree->nodes);
+    free(tree->mount);
+    free(tree->buf);
+    free(tree);
+}
+
+/**
+ * listTopCgroups - Display the top cgroups by CPU or memory (-k, -s)
+ *
+ * Uses the same count, sort key and CPU% normalization as the process
+ * list; -s pss ranks by memory.current like -s mem, the fault sorts use
+ * memory.stat pgfault/pgmajfault, and the context switch sorts (not
+ * accounted per cgroup) fall back to CPU.
+ */
+void listTopCgroups() {
+    int by_memory = SORT_BY_MEMORY(processSort);
+    int fault_field = processSort == SORT_MINFLT ? CG_MEM_PGFAULT :
+                      processSort == SORT_MAJFLT ? CG_MEM_PGMAJFAULT : -1;
+    
+    emit("\n=== Top %d Cgroups by %s ===\n", topCount, by_memory ? "Memory" :
+           fault_field == CG_MEM_PGFAULT ? "Page Faults" : fault_field == CG_MEM_PGMAJFAULT ? "Major Faults" : "CPU");
+    if (cgroupV2Missing) {
+        emit("cgroup v2 is not mounted (cgroup v1 only host); per-cgroup view unavailable.\n\n");
+        return;
+    }
+    if (cgroupDisplayTree == NULL) {
+        cgroupDisplayTree = createCgroupTree();
+        if (cgroupDisplayTree == NULL) {
+            if (errno == ENOENT) {
+                cgroupV2Missing = 1;
+                emit("cgroup v2 is not mounted (cgroup v1 only host); per-cgroup view unavailable.\n\n");
+                writeLog("Cgroups: no cgroup v2 mount, per-cgroup view disabled");
+            } else {
+                reportErrno("Error: Failed to open the cgroup v2 hierarchy");
+            }
+            return;
+        }
+    }
+    
+    int count = sampleCgroups(cgroupDisplayTree);
+    
+    // CPU% needs an interval, like the first process scan
+    if (count >= 0 && cgroupDisplayTree->elapsed == 0 && !by_memory) {
+        struct timespec delay = { 0, PROC_FIRST_SAMPLE_MS * 1000000L };
+        nanosleep(&delay, NULL);
+        count = sampleCgroups(cgroupDisplayTree);
+    }
+    if (count < 0) {
+        reportErrno("Error: Failed to read the cgroup v2 hierarchy");
+        writeLog("Error: Failed to read the cgroup v2 hierarchy");
+        return;
+    }
+    
+    double scale = 100.0 / 1e6; // usec per second -> percent of one core
+    if (procCpuNormalize == NORMALIZE_MACHINE) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        scale /= cpus > 0 ? cpus : 1;
+    }
+    
+    // The root cgroup covers the whole machine, so only its descendants are ranked
+    int populated = 0;
+    if (resetTopK(&cgroupRanking, topCount) != 0) {
+        reportError("Error: Out of memory for cgroup ranking\n");
+        return;
+    }
+    for (int i = 1; i < cgroupDisplayTree->count; i++) {
+        const struct CgroupNode *node = &cgroupDisplayTree->nodes[i];
+        if (!node->populated) {
+            continue;
+        }
+        populated++;
+        double cpu = getCgroupRate(cgroupDisplayTree, node, CG_CPU_USAGE);
+        if (by_memory) {
+            offerTopK(&cgroupRanking, (double)node->mem_current, node->curr[CG_CPU_USAGE], i);
+        } else if (fault_field >= 0) {
+            double faults = getCgroupRate(cgroupDisplayTree, node, fault_field);
+            offerTopK(&cgroupRanking, faults > 0 ? faults : 0.0, node->curr[fault_field], i);
+        } else {
+            offerTopK(&cgroupRanking, cpu > 0 ? cpu : 0.0, node->mem_current, i);
+        }
+    }
+    int display_count = finishTopK(&cgroupRanking);
+    
+    emit("%d cgroups under %s (%d populated, %d re-listed this tick)\n",
+           cgroupDisplayTree->count - 1, cgroupDisplayTree->mount, populated, cgroupDisplayTree->relisted);
+    if (display_count == 0) {
+        emit("No populated cgroups below the root.\n\n");
+        return;
+    }
+    
+    const char *cpu_header = procCpuNormalize == NORMALIZE_MACHINE ? "CPU % (all)" : "CPU % (core)";
+    double format_start = monotonicMicros();
+    emit("%-40s %12s %10s %10s %10s %8s %8s %8s\n", "Cgroup", cpu_header, "Mem (MB)",
+           "Read kB/s", "Write kB/s", "cpu PSI", "mem PSI", "io PSI");
+    emit("==============================================================================================================\n");
+    
+    for (int i = 0; i < display_count; i++) {
+        const struct CgroupNode *node = &cgroupDisplayTree->nodes[cgroupRanking.heap[i].id];
+        char cpu[16] = "-", mem[16] = "-", rd[16] = "-", wr[16] = "-";
+        char psi[3][16] = { "-", "-", "-" };
+        
+        if ((node->present & CG_HAS_CPU) && node->valid) {
+            snprintf(cpu, sizeof(cpu), "%.2f%%", getCgroupRate(cgroupDisplayTree, node, CG_CPU_USAGE) * scale);
+        }
+        if (node->present & CG_HAS_MEM) {
+            snprintf(mem, sizeof(mem), "%.1f", node->mem_current / (1024.0 * 1024.0));
+        }
+        if ((node->present & CG_HAS_IO) && node->valid) {
+            snprintf(rd, sizeof(rd), "%.1f", getCgroupRate(cgroupDisplayTree, node, CG_IO_RBYTES) / 1024.0);
+            snprintf(wr, sizeof(wr), "%.1f", getCgroupRate(cgroupDisplayTree, node, CG_IO_WBYTES) / 1024.0);
+        }
+        if ((node->present & CG_HAS_PSI) && node->valid) {
+            static const int some[PSI_RESOURCES] = { CG_CPU_SOME, CG_MEM_SOME, CG_IO_SOME };
+            for (int r = 0; r < PSI_RESOURCES; r++) {
+                snprintf(psi[r], sizeof(psi[r]), "%.2f%%",
+                         getCgroupRate(cgroupDisplayTree, node, some[r]) * 100.0 / 1e6);
+            }
+        }
+        
+        // Keep the tail of long paths, which is where they differ
+        char path[40];
+        size_t len = strlen(node->path);
+        snprintf(path, sizeof(path), "%s", len > 39 ? node->path + len - 37 : node->path);
+        sanitizeText(path, strlen(path));
+        if (len > 39) {
+            emit("...%-37s", path);
+        } else {
+            emit("/%-39s", path);
+        }
+        emit(" %12s %10s %10s %10s %8s %8s %8s\n", cpu, mem, rd, wr, psi[0], psi[1], psi[2]);
+    }
+    emit("\n");
+    stopFormatTimer(format_start);
+    
+    const struct CgroupNode *top = &cgroupDisplayTree->nodes[cgroupRanking.heap[0].id];
+    char log_msg[512];
+    if (by_memory) {
+        snprintf(log_msg, sizeof(log_msg), "Top %d cgroups by memory displayed: Top cgroup /%.300s at %.1f MB",
+                 display_count, top->path, top->mem_current / (1024.0 * 1024.0));
+    } else if (fault_field >= 0) {
+        snprintf(log_msg, sizeof(log_msg), "Top %d cgroups by faults displayed: Top cgroup /%.300s at %.1f faults/s",
+                 display_count, top->path, cgroupRanking.heap[0].key);
+    } else {
+        double cpu = getCgroupRate(cgroupDisplayTree, top, CG_CPU_USAGE);
+        snprintf(log_msg, sizeof(log_msg), "Top %d cgroups displayed: Top cgroup /%.300s at %.2f%% CPU",
+                 display_count, top->path, cpu > 0 ? cpu * scale : 0.0);
+    }
+    writeLog(log_msg);
+}
+
+// ==================== BENCHMARKS ====================
+
+/*
+ * Microbenchmarks for hot collection paths, run with -b <name>.
+ * Each one times the current implementation against the code path it
+ * replaced on the live system and prints the per-iteration cost.
+ */
+
+/**
+ * benchNow - Monotonic time in seconds for benchmark timing
+ */
+double benchNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * enumeratePidsReaddir - Baseline opendir/readdir PID walk
+ * Returns: Number of PIDs stored in *pids (grown as needed), or -1 on error
+ */
+int enumeratePidsReaddir(int **pids, size_t *capacity) {
+    DIR *proc_dir = opendir("/proc");
+    if (proc_dir == NULL) {
+        return -1;
+    }
+    
+    size_t count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(proc_dir)) != NULL) {
+        if (!isNumeric(entry->d_name)) {
+            continue;
+        }
+        if (count == *capacity) {
+            size_t new_capacity = *capacity ? *capacity * 2 : 1024;
+            int *grown = realloc(*pids, new_capacity * sizeof(**pids));
+            if (grown == NULL) {
+                closedir(proc_dir);
+                return -1;
+            }
+            *pids = grown;
+            *capacity = new_capacity;
+        }
+        (*pids)[count++] = atoi(entry->d_name);
+    }
+    
+    closedir(proc_dir);
+    return (int)count;
+}
+
+/**
+ * benchPidEnumeration - Compare readdir() and getdents64 /proc scans
+ */
+void benchPidEnumeration() {
+    const int iterations = 2000;
+    int *pids = NULL;
+    size_t capacity = 0;
+    int found_readdir = 0, found_getdents = 0;
+    
+    double start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        found_readdir = enumeratePidsReaddir(&pids, &capacity);
+    }
+    double readdir_us = (benchNow() - start) * 1e6 / iterations;
+    free(pids);
+    
+    struct PidEnumerator e = { -1, NULL, NULL, 0, 0 };
+    start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        found_getdents = enumeratePids(&e);
+    }
+    double getdents_us = (benchNow() - start) * 1e6 / iterations;
+    closePidEnumerator(&e);
+    
+    printf("\n=== Benchmark: PID enumeration (%d iterations) ===\n", iterations);
+    printf("%-24s %10s %12s\n", "Method", "PIDs", "us/scan");
+    printf("%-24s %10d %12.2f\n", "opendir/readdir", found_readdir, readdir_us);
+    printf("%-24s %10d %12.2f\n", "getdents64 batch", found_getdents, getdents_us);
+    if (getdents_us > 0) {
+        printf("Speedup: %.2fx\n\n", readdir_us / getdents_us);
+    }
+}
+
+/**
+ * benchProcessScan - Measure process-table scan time from 1 to N threads
+ *
+ * N is the number of online CPUs, or the -t value if that is larger.
+ */
+void benchProcessScan() {
+    const int iterations = 50;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = cpus > 0 ? (int)cpus : 1;
+    if (scanThreads > max_threads) {
+        max_threads = scanThreads;
+    }
+    int saved_threads = scanThreads;
+    double single_ms = 0.0;
+    
+    printf("\n=== Benchmark: process scan scaling (%d iterations, %s backend) ===\n", iterations,
+           collectBackend == BACKEND_URING ? "io_uring" : "sync");
+    printf("%-10s %10s %12s %10s\n", "Threads", "Processes", "ms/scan", "Speedup");
+    
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > max_threads) {
+            threads = max_threads;
+        }
+        scanThreads = threads;
+        int count = updateProcessTable(&processTable, NULL); // Warm up pool and table
+        
+        double start = benchNow();
+        for (int i = 0; i < iterations; i++) {
+            count = updateProcessTable(&processTable, NULL);
+        }
+        double ms = (benchNow() - start) * 1e3 / iterations;
+        if (threads == 1) {
+            single_ms = ms;
+        }
+        printf("%-10d %10d %12.3f %9.2fx\n", threads, count, ms, ms > 0 ? single_ms / ms : 0.0);
+        
+        if (threads == max_threads) {
+            break;
+        }
+    }
+    printf("\n");
+    scanThreads = saved_threads;
+}
+
+// Synthetic /proc/[PID]/stat lines in the kernel's format (init, a large
+// multi-threaded process, a kernel worker, a short-lived child, and a
+// comm containing spaces and parentheses)
+static const char *sampleStatLines[] = {
+    "1 (init) S 0 0 0 0 -1 4194560 51559 858654 69 221 144 234 1463 263 20 0 6 0 5 24281088 2308 "
+    "18446744073709551615 1 1 0 0 0 0 0 4096 1088 0 0 0 17 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "4242 (node) S 4240 4240 0 0 -1 4194304 317138 1319584 2 29 1389 123 1830 386 20 0 8 0 133251 5840072704 81479 "
+    "18446744073709551615 26389504 88791952 140730834801872 0 0 0 0 4096 1937927423 0 0 0 17 0 0 0 0 0 0 88796048 "
+    "369434624 746242048 140730834809661 140730834814927 140730834814927 140730834816994 0\n",
+    "9 (kworker/0:0-events) I 2 0 0 0 -1 69238880 0 0 0 0 2 9 0 0 20 0 1 0 5 0 0 18446744073709551615 0 0 0 0 0 0 "
+    "0 2147483647 0 1 0 0 17 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+    "8778 (cat) R 8774 8778 8774 0 -1 4194560 87 0 0 0 0 0 0 0 20 0 1 0 213099 2703360 305 18446744073709551615 "
+    "94572318302208 94572318322089 140736883774000 0 0 0 0 0 0 0 0 0 17 0 0 0 0 0 0 94572318338096 94572318339712 "
+    "94572692152320 140736883782981 140736883783043 140736883783043 140736883785707 0\n",
+    "31337 (tmux: server) (x)) S 1 31337 31337 0 -1 4194624 9121 0 0 0 5210 2231 0 0 20 0 1 0 88410 9371648 1290 "
+    "18446744073709551615 1 1 0 0 0 0 0 3674112 134433283 0 0 0 17 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+};
+
+#define SAMPLE_STAT_LINES ((int)(sizeof(sampleStatLines) / sizeof(sampleStatLines[0])))
+
+/**
+ * parseProcessStatSscanf - Baseline parser: strchr field skipping and sscanf
+ */
+int parseProcessStatSscanf(const char *buffer, char *name, size_t name_size,
+                           unsigned long *utime, unsigned long *stime, unsigned long long *starttime) {
+    const char *open_paren = strchr(buffer, '(');
+    const char *ptr = strrchr(buffer, ')');
+    if (open_paren == NULL || ptr == NULL || ptr < open_paren) {
+        return -1;
+    }
+    
+    size_t name_len = (size_t)(ptr - open_paren - 1);
+    if (name_len > name_size - 1) {
+        name_len = name_size - 1;
+    }
+    memcpy(name, open_paren + 1, name_len);
+    name[name_len] = '\0';
+    
+    ptr += 2; // Skip ") "
+    for (int i = 0; i < 11; i++) {
+        ptr = strchr(ptr, ' ');
+        if (ptr == NULL) {
+            return -1;
+        }
+        ptr++;
+    }
+    if (sscanf(ptr, "%lu %lu %*d %*d %*d %*d %*d %*d %llu", utime, stime, starttime) != 3) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * benchStatParser - Compare the sscanf stat parser with the tokenizer per space scanner
+ */
+void benchStatParser() {
+    const int iterations = 200000;
+    size_t lengths[SAMPLE_STAT_LINES];
+    struct ProcessStat stat;
+    char name[PROC_COMM_LEN];
+    unsigned long utime, stime;
+    unsigned long long starttime;
+    unsigned long long checksum = 0;
+    
+    for (int l = 0; l < SAMPLE_STAT_LINES; l++) {
+        lengths[l] = strlen(sampleStatLines[l]);
+        
+        // Both parsers must agree before their speed means anything
+        if (parseProcessStat(sampleStatLines[l], lengths[l], &stat) != 0 ||
+            parseProcessStatSscanf(sampleStatLines[l], name, sizeof(name), &utime, &stime, &starttime) != 0 ||
+            strcmp(name, stat.name) != 0 || utime != stat.field[PSTAT_UTIME] ||
+            stime != stat.field[PSTAT_STIME] || starttime != stat.field[PSTAT_STARTTIME]) {
+            printf("Error: Parsers disagree on fixture line %d\n", l);
+            return;
+        }
+    }
+    
+    printf("\n=== Benchmark: /proc/[PID]/stat parsing (%d lines x %d iterations) ===\n",
+           SAMPLE_STAT_LINES, iterations);
+    printf("%-28s %8s %12s %10s\n", "Parser", "Fields", "ns/line", "Speedup");
+    
+    double start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        for (int l = 0; l < SAMPLE_STAT_LINES; l++) {
+            parseProcessStatSscanf(sampleStatLines[l], name, sizeof(name), &utime, &stime, &starttime);
+            checksum += utime + starttime;
+        }
+    }
+    double sscanf_ns = (benchNow() - start) * 1e9 / ((double)iterations * SAMPLE_STAT_LINES);
+    printf("%-28s %8d %12.1f %9.2fx\n", "strchr + sscanf", 4, sscanf_ns, 1.0);
+    
+    struct {
+        const char *label;
+        SpaceMaskFn fn;
+    } scanners[3];
+    int scanner_count = 0;
+    scanners[scanner_count].label = "tokenizer (scalar walk)";
+    scanners[scanner_count++].fn = NULL;
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        scanners[scanner_count].label = "tokenizer (SSE2)";
+        scanners[scanner_count++].fn = maskSpacesSSE2;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        scanners[scanner_count].label = "tokenizer (AVX2)";
+        scanners[scanner_count++].fn = maskSpacesAVX2;
+    }
+#endif
+    
+    // Resolve the runtime choice first so it is not applied over the override
+    pthread_once(&maskSpacesOnce, selectMaskSpaces);
+    SpaceMaskFn selected = maskSpaces;
+    for (int k = 0; k < scanner_count; k++) {
+        // Every scanner must produce exactly the fields of the scalar walk
+        for (int l = 0; l < SAMPLE_STAT_LINES; l++) {
+            struct ProcessStat reference;
+            maskSpaces = NULL;
+            parseProcessStat(sampleStatLines[l], lengths[l], &reference);
+            maskSpaces = scanners[k].fn;
+            if (parseProcessStat(sampleStatLines[l], lengths[l], &stat) != 0 ||
+                memcmp(&stat, &reference, sizeof(stat)) != 0) {
+                maskSpaces = selected;
+                printf("Error: %s disagrees on fixture line %d\n", scanners[k].label, l);
+                return;
+            }
+        }
+        
+        start = benchNow();
+        for (int i = 0; i < iterations; i++) {
+            for (int l = 0; l < SAMPLE_STAT_LINES; l++) {
+                parseProcessStat(sampleStatLines[l], lengths[l], &stat);
+                checksum += stat.field[PSTAT_UTIME] + stat.field[PSTAT_STARTTIME];
+            }
+        }
+        double ns = (benchNow() - start) * 1e9 / ((double)iterations * SAMPLE_STAT_LINES);
+        printf("%-28s %8d %12.1f %9.2fx%s\n", scanners[k].label, PROC_STAT_FIELDS, ns,
+               ns > 0 ? sscanf_ns / ns : 0.0, scanners[k].fn == selected ? "  (selected)" : "");
+    }
+    maskSpaces = selected;
+    printf("(checksum %llu)\n\n", checksum);
+}
+
+// Synthetic /proc/stat and /proc/meminfo in the kernel's format, with
+// round numbers (two CPUs; the intr line is shortened)
+static const char sampleProcStat[] =
+    "cpu  20000 0 4000 200000 1000 0 200 0 0 0\n"
+    "cpu0 10000 0 2000 100000 500 0 100 0 0 0\n"
+    "cpu1 10000 0 2000 100000 500 0 100 0 0 0\n"
+    "intr 100000 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 1000 1000 2000 0 0 0 0 500 0 0 0 0 5000 0 0 0 0 0 0 2000 5000\n"
+    "ctxt 300000\n"
+    "btime 1000000000\n"
+    "processes 10000\n"
+    "procs_running 2\n"
+    "procs_blocked 0\n"
+    "softirq 60000 0 30000 0 2000 0 0 0 0 0 28000\n";
+
+static const char sampleMeminfo[] =
+    "MemTotal:        8000000 kB\n"     "MemFree:         4000000 kB\n"
+    "MemAvailable:    6000000 kB\n"     "Buffers:          100000 kB\n"
+    "Cached:          2000000 kB\n"     "SwapCached:            0 kB\n"
+    "Active:          1000000 kB\n"     "Inactive:        1500000 kB\n"
+    "Active(anon):     100000 kB\n"     "Inactive(anon):   500000 kB\n"
+    "Active(file):     900000 kB\n"     "Inactive(file):  1000000 kB\n"
+    "Unevictable:       10000 kB\n"     "Mlocked:           10000 kB\n"
+    "SwapTotal:             0 kB\n"     "SwapFree:              0 kB\n"
+    "Zswap:                 0 kB\n"     "Zswapped:              0 kB\n"
+    "Dirty:              1000 kB\n"     "Writeback:             0 kB\n"
+    "AnonPages:        600000 kB\n"     "Mapped:           200000 kB\n"
+    "Shmem:             20000 kB\n"     "KReclaimable:      50000 kB\n"
+    "Slab:             100000 kB\n"     "SReclaimable:      50000 kB\n"
+    "SUnreclaim:        50000 kB\n"     "KernelStack:        5000 kB\n"
+    "PageTables:        10000 kB\n"     "SecPageTables:         0 kB\n"
+    "NFS_Unstable:          0 kB\n"     "Bounce:                0 kB\n"
+    "WritebackTmp:          0 kB\n"     "CommitLimit:     4000000 kB\n"
+    "Committed_AS:    1000000 kB\n"     "VmallocTotal: 34359738367 kB\n"
+    "VmallocUsed:       20000 kB\n"     "VmallocChunk:          0 kB\n"
+    "Percpu:             1000 kB\n"     "AnonHugePages:         0 kB\n"
+    "ShmemHugePages:        0 kB\n"     "ShmemPmdMapped:        0 kB\n"
+    "FileHugePages:         0 kB\n"     "FilePmdMapped:         0 kB\n"
+    "Balloon:               0 kB\n"     "HugePages_Total:       0\n"
+    "HugePages_Free:        0\n"        "HugePages_Rsvd:        0\n"
+    "HugePages_Surp:        0\n"        "Hugepagesize:       2048 kB\n"
+    "Hugetlb:               0 kB\n"     "DirectMap4k:      100000 kB\n"
+    "DirectMap2M:     4000000 kB\n"     "DirectMap1G:     4000000 kB\n";
+
+/**
+ * parseCPUStatsSscanf - Baseline cpu-line parser: strncmp, strtol and sscanf
+ * Returns: Number of cpu lines parsed into v (rows of CPU_FIELDS)
+ */
+int parseCPUStatsSscanf(const char *buffer, unsigned long long *v, int max_rows) {
+    int rows = 0;
+    const char *line = buffer;
+    
+    while (line != NULL && strncmp(line, "cpu", 3) == 0 && rows < max_rows) {
+        const char *fields = line + 3;
+        if (*fields != ' ') {
+            char *end;
+            strtol(fields, &end, 10);
+            fields = end;
+        }
+        unsigned long long *row = v + (size_t)rows * CPU_FIELDS;
+        if (sscanf(fields, "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu", &row[0], &row[1],
+                   &row[2], &row[3], &row[4], &row[5], &row[6], &row[7], &row[8], &row[9]) < CPU_SOFTIRQ + 1) {
+            return -1;
+        }
+        rows++;
+        line = strchr(line, '\n');
+        if (line != NULL) {
+            line++;
+        }
+    }
+    return rows;
+}
+
+/**
+ * parseMeminfoStrtol - Baseline meminfo parser: strstr and strtol per key
+ */
+int parseMeminfoStrtol(const char *buffer, struct MemInfo *info) {
+    memset(info, 0, sizeof(*info));
+    for (int i = 0; i < MEMINFO_KEYS; i++) {
+        const char *ptr = strstr(buffer, memInfoKeys[i].key);
+        // "Cached:" must not match inside "SwapCached:"
+        while (ptr != NULL && ptr != buffer && ptr[-1] != '\n') {
+            ptr = strstr(ptr + 1, memInfoKeys[i].key);
+        }
+        if (ptr != NULL) {
+            unsigned long long *field = (unsigned long long *)((char *)info + memInfoKeys[i].offset);
+            *field = strtoull(ptr + memInfoKeys[i].len, NULL, 10);
+            info->present |= 1u << i;
+        }
     }
-    
-    return 0;
+    return MEMINFO_HAS(info, MEMINFO_TOTAL) ? 0 : -1;
 }
 
 /**
- * calculateCPUUsage - Calculate CPU usage percentage from current and previous values
+ * benchParsers - Compare every /proc parser with the sscanf/strtol code it replaced
+ *
+ * Each pair is first checked to produce the same values on the synthetic
+ * fixtures; the cursor parsers additionally reject overflowing numbers.
  */
-double calculateCPUUsage(unsigned long long user, unsigned long long nice,
-                        unsigned long long system, unsigned long long idle,
-                        unsigned long long iowait, unsigned long long irq,
-                        unsigned long long softirq) {
+void benchParsers() {
+    const int iterations = 200000;
+    size_t stat_len = sizeof(sampleProcStat) - 1;
+    size_t meminfo_len = sizeof(sampleMeminfo) - 1;
+    struct CPUCounters counters;
+    unsigned long long baseline_cpu[4 * CPU_FIELDS];
+    struct MemInfo info, baseline_info;
+    struct ProcessStat pstat;
+    char name[PROC_COMM_LEN];
+    unsigned long utime, stime;
+    unsigned long long starttime;
+    unsigned long long checksum = 0;
+    double start, old_ns[3], new_ns[3];
+    size_t stat_lengths[SAMPLE_STAT_LINES];
     
-    if (first_run) {
-        prev_user = user;
-        prev_nice = nice;
-        prev_system = system;
-        prev_idle = idle;
-        prev_iowait = iowait;
-        prev_irq = irq;
-        prev_softirq = softirq;
-        first_run = 0;
-        return -1.0;
+    for (int l = 0; l < SAMPLE_STAT_LINES; l++) {
+        stat_lengths[l] = strlen(sampleStatLines[l]);
+    }
+    memset(&counters, 0, sizeof(counters));
+    int rows = parseCPUStatsSscanf(sampleProcStat, baseline_cpu, 4);
+    if (parseCPUStats(sampleProcStat, stat_len, &counters) + 1 != rows ||
+        memcmp(counters.curr, baseline_cpu, (size_t)rows * CPU_FIELDS * sizeof(*baseline_cpu)) != 0 ||
+        parseMeminfo(sampleMeminfo, meminfo_len, &info) != 0 ||
+        parseMeminfo(sampleMeminfo, meminfo_len, &info) != 0 || // Second parse: at remembered offsets
+        parseMeminfoStrtol(sampleMeminfo, &baseline_info) != 0 ||
+        memcmp(&info, &baseline_info, sizeof(info)) != 0) {
+        printf("Error: Parsers disagree on the fixtures\n");
+        freeCPUCounters(&counters);
+        return;
     }
     
-    unsigned long long user_delta = user - prev_user;
-    unsigned long long nice_delta = nice - prev_nice;
-    unsigned long long system_delta = system - prev_system;
-    unsigned long long idle_delta = idle - prev_idle;
-    unsigned long long iowait_delta = iowait - prev_iowait;
-    unsigned long long irq_delta = irq - prev_irq;
-    unsigned long long softirq_delta = softirq - prev_softirq;
-    
-    unsigned long long total_delta = user_delta + nice_delta + system_delta + 
-                                     idle_delta + iowait_delta + irq_delta + softirq_delta;
-    
-    if (total_delta == 0) {
-        return 0.0;
+    start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        checksum += (unsigned long long)parseCPUStatsSscanf(sampleProcStat, baseline_cpu, 4) + baseline_cpu[0];
+    }
+    old_ns[0] = (benchNow() - start) * 1e9 / iterations;
+    start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        checksum += (unsigned long long)parseCPUStats(sampleProcStat, stat_len, &counters) + counters.curr[0];
     }
+    new_ns[0] = (benchNow() - start) * 1e9 / iterations;
     
-    double cpu_usage = 100.0 * (1.0 - ((double)idle_delta / (double)total_delta));
+    start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        parseMeminfoStrtol(sampleMeminfo, &baseline_info);
+        checksum += baseline_info.free;
+    }
+    old_ns[1] = (benchNow() - start) * 1e9 / iterations;
+    start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        parseMeminfo(sampleMeminfo, meminfo_len, &info);
+        checksum += info.free;
+    }
+    new_ns[1] = (benchNow() - start) * 1e9 / iterations;
     
-    prev_user = user;
-    prev_nice = nice;
-    prev_system = system;
-    prev_idle = idle;
-    prev_iowait = iowait;
-    prev_irq = irq;
-    prev_softirq = softirq;
+    start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        int l = i % SAMPLE_STAT_LINES;
+        parseProcessStatSscanf(sampleStatLines[l], name, sizeof(name), &utime, &stime, &starttime);
+        checksum += utime;
+    }
+    old_ns[2] = (benchNow() - start) * 1e9 / iterations;
+    start = benchNow();
+    for (int i = 0; i < iterations; i++) {
+        int l = i % SAMPLE_STAT_LINES;
+        parseProcessStat(sampleStatLines[l], stat_lengths[l], &pstat);
+        checksum += pstat.field[PSTAT_UTIME];
+    }
+    new_ns[2] = (benchNow() - start) * 1e9 / iterations;
+    freeCPUCounters(&counters);
     
-    return cpu_usage;
+    const char *fixtures[3] = { "/proc/stat", "/proc/meminfo", "/proc/[PID]/stat" };
+    printf("\n=== Benchmark: /proc parsers on synthetic fixtures (%d iterations) ===\n", iterations);
+    printf("%-20s %16s %16s %10s\n", "Fixture", "sscanf/strtol ns", "cursor ns", "Speedup");
+    for (int f = 0; f < 3; f++) {
+        printf("%-20s %16.1f %16.1f %9.2fx\n", fixtures[f], old_ns[f], new_ns[f],
+               new_ns[f] > 0 ? old_ns[f] / new_ns[f] : 0.0);
+    }
+    printf("(checksum %llu)\n\n", checksum);
+}
+
+// One row of the default process view, as listTopProcesses() prints it
+struct BenchRow {
+    int pid;
+    const char *user;
+    const char *name;
+    unsigned long total_time;
+    double cpu_percent;
+    const char *cgroup;
+    const char *cmdline;
+};
+
+static void formatRowPrintf(const struct BenchRow *row) {
+    emit("%-8d %-10.10s %-24.24s %-12lu %7.2f%%      %-24.24s %.40s\n", row->pid, row->user, row->name,
+         row->total_time, row->cpu_percent, row->cgroup, row->cmdline);
+}
+
+static void formatRowFixed(const struct BenchRow *row) {
+    emitSigned(row->pid, -8);
+    emitText(" ", 1);
+    emitPadded(row->user, -10);
+    emitText(" ", 1);
+    emitPadded(row->name, -24);
+    emitText(" ", 1);
+    emitUnsigned(row->total_time, -12);
+    emitText(" ", 1);
+    emitFixed(row->cpu_percent, 2, 7);
+    emitString("%      ");
+    emitPadded(row->cgroup, -24);
+    emitText(" ", 1);
+    emitClipped(row->cmdline, 40);
+    emitText("\n", 1);
 }
 
 /**
- * getCPUUsage - Read CPU statistics and display usage percentage
+ * benchFormatters - Compare printf-style emit() with the fixed formatters on process rows
+ *
+ * Both are checked to produce identical rows first. CPU% values are
+ * chosen off exact ties, where the two round differently (see emitFixed).
  */
-void getCPUUsage() {
-    int fd;
-    char buffer[4096];
-    ssize_t bytes_read;
+void benchFormatters() {
+    static const char *const names[] = { "systemd", "kworker/3:1H-kblockd", "postgres: checkpointer", "sshd" };
+    static const char *const cmdlines[] = {
+        "/sbin/init", "-", "postgres: checkpointer process for the main cluster", "sshd: /usr/sbin/sshd -D"
+    };
+    const int rows_per_frame = 200;
+    const int frames = 2000;
+    struct BenchRow rows[200];
+    struct FrameBuffer saved = frameBuffer;
+    double start, printf_ns, fixed_ns;
+    unsigned long long checksum = 0;
     
-    fd = open("/proc/stat", O_RDONLY);
-    if (fd == -1) {
-        perror("Error: Failed to open /proc/stat");
-        return;
+    for (int i = 0; i < rows_per_frame; i++) {
+        rows[i].pid = 1 + i * 7919 % 4194304;
+        rows[i].user = i % 3 ? "root" : "postgres-admin";
+        rows[i].name = names[i % 4];
+        rows[i].total_time = (unsigned long)i * 104729UL;
+        rows[i].cpu_percent = i * 0.4937 + 0.0013;
+        rows[i].cgroup = i % 2 ? "system.slice/postgresql.service" : "user.slice";
+        rows[i].cmdline = cmdlines[i % 4];
     }
     
-    bytes_read = read(fd, buffer, sizeof(buffer) - 1);
-    if (bytes_read == -1) {
-        perror("Error: Failed to read /proc/stat");
-        close(fd);
-        return;
+    frameBuffer.data = NULL;
+    frameBuffer.len = frameBuffer.cap = 0;
+    frameBuffer.active = 1;
+    char expected[256];
+    for (int i = 0; i < rows_per_frame; i++) {
+        frameBuffer.len = 0;
+        formatRowPrintf(&rows[i]);
+        size_t len = frameBuffer.len < sizeof(expected) ? frameBuffer.len : sizeof(expected);
+        memcpy(expected, frameBuffer.data, len);
+        frameBuffer.len = 0;
+        formatRowFixed(&rows[i]);
+        if (frameBuffer.len != len || memcmp(frameBuffer.data, expected, len) != 0) {
+            free(frameBuffer.data);
+            frameBuffer = saved;
+            printf("Error: Formatters disagree on row %d\n", i);
+            return;
+        }
     }
     
-    buffer[bytes_read] = '\0';
-    
-    if (close(fd) == -1) {
-        perror("Warning: Failed to close /proc/stat");
+    start = benchNow();
+    for (int f = 0; f < frames; f++) {
+        frameBuffer.len = 0;
+        for (int i = 0; i < rows_per_frame; i++) {
+            formatRowPrintf(&rows[i]);
+        }
+        checksum += frameBuffer.len;
     }
-    
-    unsigned long long user, nice, system, idle, iowait, irq, softirq;
-    if (parseCPUStats(buffer, &user, &nice, &system, &idle, &iowait, &irq, &softirq) != 0) {
-        fprintf(stderr, "Error: Failed to parse CPU statistics\n");
-        return;
+    printf_ns = (benchNow() - start) * 1e9 / ((double)frames * rows_per_frame);
+    start = benchNow();
+    for (int f = 0; f < frames; f++) {
+        frameBuffer.len = 0;
+        for (int i = 0; i < rows_per_frame; i++) {
+            formatRowFixed(&rows[i]);
+        }
+        checksum += frameBuffer.len;
     }
+    fixed_ns = (benchNow() - start) * 1e9 / ((double)frames * rows_per_frame);
+    free(frameBuffer.data);
+    frameBuffer = saved;
     
-    double cpu_usage = calculateCPUUsage(user, nice, system, idle, iowait, irq, softirq);
-    
-    if (cpu_usage < 0) {
-        printf("\n=== CPU Usage ===\n");
-        printf("Initializing CPU monitoring...\n");
-        printf("Run again to see CPU usage.\n\n");
-        writeLog("CPU monitoring initialized");
-        return;
+    printf("\n=== Benchmark: process row formatting (%d frames of %d rows) ===\n", frames, rows_per_frame);
+    printf("%-20s %12s %12s\n", "Formatter", "ns/row", "us/frame");
+    printf("%-20s %12.1f %12.1f\n", "emit (vsnprintf)", printf_ns, printf_ns * rows_per_frame / 1000.0);
+    printf("%-20s %12.1f %12.1f\n", "fixed formatters", fixed_ns, fixed_ns * rows_per_frame / 1000.0);
+    printf("Speedup: %.2fx (checksum %llu)\n\n", fixed_ns > 0 ? printf_ns / fixed_ns : 0.0, checksum);
+}
+
+/**
+ * runBenchmark - Run a named microbenchmark
+ */
+void runBenchmark(const char *name) {
+    if (strcmp(name, "pids") == 0) {
+        benchPidEnumeration();
+    } else if (strcmp(name, "scan") == 0) {
+        benchProcessScan();
+    } else if (strcmp(name, "stat") == 0) {
+        benchStatParser();
+    } else if (strcmp(name, "parse") == 0) {
+        benchParsers();
+    } else if (strcmp(name, "format") == 0) {
+        benchFormatters();
+    } else {
+        printf("Error: Unknown benchmark '%s'. Use -b [pids|scan|stat|parse|format]\n", name);
     }
-    
-    printf("\n=== CPU Usage ===\n");
-    printf("CPU Usage: %.1f%%\n\n", cpu_usage);
-    
-    char log_msg[256];
-    snprintf(log_msg, sizeof(log_msg), "CPU Usage: %.1f%%", cpu_usage);
-    writeLog(log_msg);
 }
 
-// ==================== MEMORY USAGE MODULE (CONTRIBUTOR 2) ====================
+// ==================== MAIN CONTROL & CONTINUOUS MONITORING (CONTRIBUTOR 4) ====================
 
 /*
- * Contributor 2: Memory Usage Module
- * Responsibility: Implement memory monitoring functionality
- * - Reads /proc/meminfo using system calls
- * - Calculates Total, Used, and Free memory
- * - Displays formatted output and logs to syslog.txt
+ * Differential terminal renderer for continuous mode. Each tick composes
+ * the whole frame through emit(); renderFrame() compares it line by line
+ * with the frame on screen and sends only what changed (from the first
+ * differing column, with ANSI cursor addressing) in a single write().
+ * When stdout is not a terminal every frame is written out as plain text.
  */
+struct FrameRenderer {
+    char *prev;             // Frame currently on screen (swapped with frameBuffer)
+    size_t prev_len;
+    size_t prev_cap;
+    int prev_rows;          // Screen rows the previous frame used
+    char *out;              // Escape sequences and text of one update
+    size_t out_len;
+    size_t out_cap;
+    int rows;               // Terminal size the screen was drawn for
+    int cols;
+    int drawn;              // prev is on screen; 0 forces a full redraw
+    int tty;                // stdout is a terminal
+    int active;             // Between startRenderer() and stopRenderer()
+};
 
-void getMemoryUsage() {
-    int fd;
-    char buffer[2048];
-    ssize_t bytesRead;
-
-    // 1. Open /proc/meminfo using low-level system call
-    fd = open("/proc/meminfo", O_RDONLY);
-    if (fd == -1) {
-        perror("Error opening /proc/meminfo");
-        return;
-    }
+#define FRAME_MIN_BUF 16384
 
-    // 2. Read the content into a buffer
-    // We read enough bytes to ensure we capture MemTotal and MemFree (usually at the top)
-    bytesRead = read(fd, buffer, sizeof(buffer) - 1);
-    if (bytesRead == -1) {
-        perror("Error reading /proc/meminfo");
-        close(fd);
-        return;
-    }
-    buffer[bytesRead] = '\0'; // Null-terminate the string
-    close(fd);
+static struct FrameRenderer frameRenderer;
 
-    // 3. Parse MemTotal and MemFree
-    // We manually search for the substrings since we are using a raw buffer
-    long memTotal_kB = 0, memFree_kB = 0;
-    
-    char *totalPtr = strstr(buffer, "MemTotal:");
-    if (totalPtr) {
-        memTotal_kB = strtol(totalPtr + 9, NULL, 10); // Skip "MemTotal:" (9 chars)
+/**
+ * appendOutput - Append bytes to the pending terminal update
+ * Returns: 0 on success, -1 on allocation failure
+ */
+static int appendOutput(struct FrameRenderer *r, const char *data, size_t len) {
+    if (r->out_len + len > r->out_cap) {
+        size_t cap = r->out_cap ? r->out_cap : FRAME_MIN_BUF;
+        while (cap < r->out_len + len) {
+            cap *= 2;
+        }
+        char *grown = realloc(r->out, cap);
+        if (grown == NULL) {
+            return -1;
+        }
+        r->out = grown;
+        r->out_cap = cap;
     }
+    memcpy(r->out + r->out_len, data, len);
+    r->out_len += len;
+    return 0;
+}
 
-    char *freePtr = strstr(buffer, "MemFree:");
-    if (freePtr) {
-        memFree_kB = strtol(freePtr + 8, NULL, 10); // Skip "MemFree:" (8 chars)
-    }
+/**
+ * appendCursorMove - Append an ANSI "move to row;col" (both 1-based)
+ */
+static int appendCursorMove(struct FrameRenderer *r, int row, int col) {
+    char seq[32];
+    int len = snprintf(seq, sizeof(seq), "\033[%d;%dH", row, col);
+    return appendOutput(r, seq, (size_t)len);
+}
 
-    // 4. Calculate Statistics (Convert kB to MB)
-    long memTotal_MB = memTotal_kB / 1024;
-    long memFree_MB = memFree_kB / 1024;
-    long memUsed_MB = memTotal_MB - memFree_MB; // Formula: Used = Total - Free
-    
-    double usagePercent = 0.0;
-    if (memTotal_MB > 0) {
-        usagePercent = ((double)memUsed_MB / memTotal_MB) * 100.0;
+/**
+ * writeAll - write() a buffer, retrying short writes and EINTR
+ * Returns: 0 on success, -1 on error
+ */
+static int writeAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
     }
-
-    // 5. Display Output to Terminal
-    printf("\n=== Memory Usage ===\n");
-    printf("Total Memory:  %ld MB\n", memTotal_MB);
-    printf("Used Memory:   %ld MB\n", memUsed_MB);
-    printf("Free Memory:   %ld MB\n", memFree_MB);
-    printf("Usage:         %.1f%%\n", usagePercent);
-    printf("====================\n");
-
-    // 6. Logging
-    // Format the log string. Note: writeLog() is a shared helper from your leader.
-    char logMsg[256];
-    snprintf(logMsg, sizeof(logMsg), "Memory - Total: %ldMB, Used: %ldMB, Free: %ldMB (%.1f%%)", 
-             memTotal_MB, memUsed_MB, memFree_MB, usagePercent);
-    
-    writeLog(logMsg); 
+    return 0;
 }
 
-// ==================== TOP PROCESSES MODULE (CONTRIBUTOR 3) ====================
-
-//Structure to store process information
-struct ProcessInfo {   
-    int pid;
-    char name[256];
-    unsigned long utime;      // User mode CPU time
-    unsigned long stime;      // Kernel mode CPU time
-    unsigned long total_time; // Total CPU time
-    double cpu_percent;
-};
-
 /**
- * isNumeric - Check if string contains only digits (helper for PID detection)
+ * beginFrame - Start composing a frame; emit() output is collected until renderFrame()
+ * Returns: 0 on success, -1 on allocation failure (output then goes to stdout)
  */
-int isNumeric(const char *str) {
-    if (str == NULL || *str == '\0') {
-        return 0;
-    }
-    
-    while (*str) {
-        if (*str < '0' || *str > '9') {
-            return 0;
+int beginFrame() {
+    if (frameBuffer.data == NULL) {
+        frameBuffer.data = malloc(FRAME_MIN_BUF);
+        if (frameBuffer.data == NULL) {
+            return -1;
         }
-        str++;
+        frameBuffer.cap = FRAME_MIN_BUF;
     }
-    return 1;
+    fflush(stdout);
+    frameBuffer.len = 0;
+    frameBuffer.active = 1;
+    frameStats.format_us = 0.0;
+    return 0;
 }
 
 /**
- * readProcessName - Read process name from /proc/[PID]/comm
+ * reportFrameStats - Emit the frame footer: this frame's formatting time and the last update,
+ *                    and the latest module error if one was reported since the last frame
  */
-int readProcessName(int pid, char *name, size_t name_size) {
-    char path[256];
-    int fd;
-    ssize_t bytes_read;
-    
-    snprintf(path, sizeof(path), "/proc/%d/comm", pid);
-    
-    fd = open(path, O_RDONLY);
-    if (fd == -1) {
-        return -1;
-    }
-    
-    bytes_read = read(fd, name, name_size - 1);
-    close(fd);
-    
-    if (bytes_read <= 0) {
-        return -1;
+void reportFrameStats() {
+    double format_start = monotonicMicros();
+    emitString("Frame: formatted in ");
+    emitFixed(frameStats.format_us, 0, 0);
+    emitString(" us");
+    if (frameStats.frames > 0) {
+        emitString("; last frame ");
+        emitUnsigned(frameStats.last_bytes, 0);
+        emitString(" bytes, ");
+        emitUnsigned(frameStats.last_written, 0);
+        emitString(" written in ");
+        emitFixed(frameStats.last_render_us, 0, 0);
+        emitString(" us");
     }
-    
-    name[bytes_read] = '\0';
-    
-    // Remove newline if present
-    if (bytes_read > 0 && name[bytes_read - 1] == '\n') {
-        name[bytes_read - 1] = '\0';
+    emitText("\n", 1);
+    if (lastError[0] != '\0') {
+        emitString("Last error: ");
+        emitString(lastError);
+        emitString(" (see syslog.txt)\n");
+        lastError[0] = '\0';
     }
-    
-    return 0;
+    stopFormatTimer(format_start);
 }
 
 /**
- * readProcessStat - Read CPU time from /proc/[PID]/stat
+ * startRenderer - Prepare the terminal for continuous mode (hide the cursor)
  */
-int readProcessStat(int pid, unsigned long *utime, unsigned long *stime) {
-    char path[256];
-    char buffer[4096];
-    int fd;
-    ssize_t bytes_read;
-    
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
-    
-    fd = open(path, O_RDONLY);
-    if (fd == -1) {
-        return -1;
-    }
-    
-    bytes_read = read(fd, buffer, sizeof(buffer) - 1);
-    close(fd);
+void startRenderer() {
+    struct FrameRenderer *r = &frameRenderer;
     
-    if (bytes_read <= 0) {
-        return -1;
+    r->tty = isatty(STDOUT_FILENO);
+    r->drawn = 0;
+    r->prev_rows = 0;
+    r->active = 1;
+    errorsToLog = 1;
+    setlocale(LC_CTYPE, "");    // Character widths of the user's terminal
+    memset(&frameStats, 0, sizeof(frameStats));
+    if (r->tty) {
+        fflush(stdout);
+        writeAll(STDOUT_FILENO, "\033[?25l", 6);
     }
+}
+
+/**
+ * recordFrame - Update frameStats once a frame has been written
+ */
+static void recordFrame(size_t bytes, size_t written, double start) {
+    frameStats.last_format_us = frameStats.format_us;
+    frameStats.last_render_us = monotonicMicros() - start;
+    frameStats.last_bytes = bytes;
+    frameStats.last_written = written;
+    frameStats.frames++;
+    frameStats.total_format_us += frameStats.last_format_us;
+    frameStats.total_render_us += frameStats.last_render_us;
+}
+
+/**
+ * utf8Char - Length in bytes and terminal width of the character at the start of text
+ * @text: Text (at least one byte)
+ * @len: Bytes available
+ * @width: Set to the columns the character takes
+ * Returns: Its length in bytes
+ *
+ * A byte that does not start a complete UTF-8 sequence is taken on its
+ * own, one column wide (the terminal shows a replacement for it), as is
+ * any character wcwidth() does not know. Combining marks are zero wide.
+ */
+static size_t utf8Char(const char *text, size_t len, int *width) {
+    unsigned char c = (unsigned char)text[0];
+    size_t n = c < 0x80 ? 1 : (c & 0xe0) == 0xc0 ? 2 : (c & 0xf0) == 0xe0 ? 3 : (c & 0xf8) == 0xf0 ? 4 : 1;
     
-    buffer[bytes_read] = '\0';
-    
-    // Parse the stat file
-    // Format: pid (comm) state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt utime stime...
-    // We need fields 14 (utime) and 15 (stime)
-    
-    char *ptr = strchr(buffer, ')'); // Find end of process name
-    if (ptr == NULL) {
-        return -1;
+    *width = 1;
+    if (n == 1 || n > len) {
+        return 1;
     }
-    
-    ptr += 2; // Skip ") "
-    
-    // Skip fields 3-13 (11 fields)
-    for (int i = 0; i < 11; i++) {
-        ptr = strchr(ptr, ' ');
-        if (ptr == NULL) {
-            return -1;
+    wchar_t wc = c & (0x7f >> n);
+    for (size_t i = 1; i < n; i++) {
+        unsigned char cont = (unsigned char)text[i];
+        if ((cont & 0xc0) != 0x80) {
+            return 1;
         }
-        ptr++; // Move past space
+        wc = (wc << 6) | (cont & 0x3f);
     }
-    
-    // Now we're at field 14 (utime)
-    if (sscanf(ptr, "%lu %lu", utime, stime) != 2) {
-        return -1;
+    int w = wcwidth(wc);
+    if (w >= 0) {
+        *width = w;
     }
-    
-    return 0;
+    return n;
 }
 
 /**
- * compareProcesses - Comparison function for qsort (descending order by CPU time)
+ * lineSpan - Bytes of a line that fit in the terminal width
+ * @line: Line (without its newline)
+ * @len: Its length in bytes
+ * @cols: Columns available
+ * @width: Set to the columns the returned bytes take
+ * Returns: Number of bytes to show; never ends inside a UTF-8 sequence
  */
-int compareProcesses(const void *a, const void *b) {
-    struct ProcessInfo *proc_a = (struct ProcessInfo *)a;
-    struct ProcessInfo *proc_b = (struct ProcessInfo *)b;
+static size_t lineSpan(const char *line, size_t len, int cols, int *width) {
+    size_t pos = 0;
+    int col = 0;
     
-    if (proc_b->total_time > proc_a->total_time) {
-        return 1;
-    } else if (proc_b->total_time < proc_a->total_time) {
-        return -1;
+    while (pos < len) {
+        int w = 1;
+        size_t n = (unsigned char)line[pos] < 0x80 ? 1 : utf8Char(line + pos, len - pos, &w);
+        if (col + w > cols) {
+            break;
+        }
+        pos += n;
+        col += w;
     }
-    return 0;
+    *width = col;
+    return pos;
 }
 
 /**
- * listTopProcesses - Display top 5 CPU-consuming processes
+ * renderFrame - Finish the frame and bring the screen up to date with one write()
+ * Returns: Bytes written to the terminal, or -1 on error
+ *
+ * Lines are clipped to the terminal width (so none wraps), counted in
+ * display columns of UTF-8 text. A changed line is rewritten from the
+ * first character that differs (backing up over combining marks to the
+ * cell they belong to) and cleared to the end if it got shorter; lines
+ * the previous frame had below the new one are cleared. A resize
+ * redraws everything.
+ *
+ * A frame with more lines than the screen has rows (less one) cannot be
+ * diffed in place: it is written out whole after clearing the screen
+ * and left to scroll, as the plain report was, so its end (the process
+ * lists) stays in view. Diffing resumes once a frame fits again.
  */
-void listTopProcesses() {
-    DIR *proc_dir;
-    struct dirent *entry;
-    struct ProcessInfo processes[1024];
-    int process_count = 0;
+ssize_t renderFrame() {
+    struct FrameRenderer *r = &frameRenderer;
+    const char *frame = frameBuffer.data;
+    size_t frame_len = frameBuffer.len;
+    double start = monotonicMicros();
     
-    printf("\n=== Top 5 Active Processes ===\n");
+    frameBuffer.active = 0;
+    if (frame == NULL) {
+        return -1;
+    }
+    if (!r->tty) {
+        if (writeAll(STDOUT_FILENO, frame, frame_len) != 0) {
+            return -1;
+        }
+        recordFrame(frame_len, frame_len, start);
+        return (ssize_t)frame_len;
+    }
     
-    // Open /proc directory
-    proc_dir = opendir("/proc");
-    if (proc_dir == NULL) {
-        perror("Error: Failed to open /proc directory");
-        writeLog("Error: Failed to open /proc directory");
-        return;
+    struct winsize ws;
+    int rows = 24, cols = 80;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        rows = ws.ws_row;
+        cols = ws.ws_col;
     }
+    int full = !r->drawn || rows != r->rows || cols != r->cols;
     
-    // Read all process entries
-    while ((entry = readdir(proc_dir)) != NULL && process_count < 1024) {
-        // Check if entry name is numeric (PID)
-        if (!isNumeric(entry->d_name)) {
-            continue;
+    int lines = 0;
+    for (const char *p = frame; p < frame + frame_len; lines++) {
+        const char *nl = memchr(p, '\n', (size_t)(frame + frame_len - p));
+        p = nl ? nl + 1 : frame + frame_len;
+    }
+    
+    r->out_len = 0;
+    if (lines > rows - 1) {
+        appendOutput(r, "\033[H\033[2J", 7);
+        for (const char *p = frame; p < frame + frame_len; ) {
+            const char *nl = memchr(p, '\n', (size_t)(frame + frame_len - p));
+            int width;
+            appendOutput(r, p, lineSpan(p, (size_t)((nl ? nl : frame + frame_len) - p), cols, &width));
+            appendOutput(r, "\n", 1);
+            p = nl ? nl + 1 : frame + frame_len;
         }
-        
-        int pid = atoi(entry->d_name);
-        unsigned long utime, stime;
-        
-        // Read process statistics
-        if (readProcessStat(pid, &utime, &stime) != 0) {
-            continue; // Process may have terminated, skip it
+        r->drawn = 0;   // The screen no longer matches prev
+        if (writeAll(STDOUT_FILENO, r->out, r->out_len) != 0) {
+            return -1;
         }
+        recordFrame(frame_len, r->out_len, start);
+        return (ssize_t)r->out_len;
+    }
+    if (full) {
+        appendOutput(r, "\033[H\033[2J", 7);
+    }
+    
+    const char *a = frame, *a_end = frame + frame_len;
+    const char *b = r->prev, *b_end = r->prev + (full ? 0 : r->prev_len);
+    int row = 0;
+    while (a < a_end && row < rows - 1) {
+        const char *a_nl = memchr(a, '\n', (size_t)(a_end - a));
+        size_t a_len = (size_t)((a_nl ? a_nl : a_end) - a);
+        int a_width;
+        size_t a_show = lineSpan(a, a_len, cols, &a_width);
         
-        // Read process name
-        char name[256];
-        if (readProcessName(pid, name, sizeof(name)) != 0) {
-            snprintf(name, sizeof(name), "[unknown]");
+        if (b < b_end) {
+            const char *b_nl = memchr(b, '\n', (size_t)(b_end - b));
+            size_t b_len = (size_t)((b_nl ? b_nl : b_end) - b);
+            int b_width;
+            size_t b_show = lineSpan(b, b_len, cols, &b_width);
+            
+            size_t same = 0;
+            while (same < a_show && same < b_show && a[same] == b[same]) {
+                same++;
+            }
+            if (same < a_show || same < b_show) {
+                // Restart at the last character before the difference
+                // that begins a cell in both lines
+                size_t pos = 0, cut = 0;
+                int col = 0, cut_col = 0;
+                for (;;) {
+                    int wa = 1, wb = 1;
+                    size_t n = pos < a_show ? utf8Char(a + pos, a_show - pos, &wa) : 0;
+                    if (pos < b_show) {
+                        utf8Char(b + pos, b_show - pos, &wb);
+                    }
+                    if (wa > 0 && wb > 0) {
+                        cut = pos;
+                        cut_col = col;
+                    }
+                    if (n == 0 || pos + n > same) {
+                        break;
+                    }
+                    pos += n;
+                    col += wa;
+                }
+                appendCursorMove(r, row + 1, cut_col + 1);
+                appendOutput(r, a + cut, a_show - cut);
+                if (a_width < b_width) {
+                    appendOutput(r, "\033[K", 3);
+                }
+            }
+            b = b_nl ? b_nl + 1 : b_end;
+        } else if (a_show > 0) {
+            appendCursorMove(r, row + 1, 1);
+            appendOutput(r, a, a_show);
+            if (!full) {
+                appendOutput(r, "\033[K", 3);
+            }
         }
         
-        // Store process information
-        processes[process_count].pid = pid;
-        strncpy(processes[process_count].name, name, sizeof(processes[process_count].name) - 1);
-        processes[process_count].name[sizeof(processes[process_count].name) - 1] = '\0';
-        processes[process_count].utime = utime;
-        processes[process_count].stime = stime;
-        processes[process_count].total_time = utime + stime;
-        
-        process_count++;
+        a = a_nl ? a_nl + 1 : a_end;
+        row++;
     }
     
-    closedir(proc_dir);
-    
-    if (process_count == 0) {
-        printf("No processes found.\n\n");
-        writeLog("No processes found");
-        return;
+    // Everything below a shorter frame is stale
+    if (!full && row < r->prev_rows) {
+        appendCursorMove(r, row + 1, 1);
+        appendOutput(r, "\033[J", 3);
     }
+    appendCursorMove(r, row + 1, 1);
     
-    // Sort processes by total CPU time (descending)
-    qsort(processes, process_count, sizeof(struct ProcessInfo), compareProcesses);
-    
-    // Calculate CPU percentages (relative to top process)
-    unsigned long max_time = processes[0].total_time;
-    if (max_time > 0) {
-        for (int i = 0; i < process_count; i++) {
-            processes[i].cpu_percent = (100.0 * processes[i].total_time) / max_time;
-        }
+    if (writeAll(STDOUT_FILENO, r->out, r->out_len) != 0) {
+        r->drawn = 0;
+        return -1;
     }
     
-    // Display header
-    printf("%-10s %-30s %-15s %-10s\n", "PID", "Process Name", "CPU Time", "Relative %");
-    printf("=======================================================================\n");
+    // The composed frame becomes the reference for the next diff
+    char *data = r->prev;
+    size_t cap = r->prev_cap;
+    r->prev = frameBuffer.data;
+    r->prev_len = frameBuffer.len;
+    r->prev_cap = frameBuffer.cap;
+    frameBuffer.data = data;
+    frameBuffer.cap = cap;
+    frameBuffer.len = 0;
+    r->prev_rows = row;
+    r->rows = rows;
+    r->cols = cols;
+    r->drawn = 1;
+    recordFrame(frame_len, r->out_len, start);
+    return (ssize_t)r->out_len;
+}
+
+/**
+ * stopRenderer - Leave the cursor below the last frame and show it again, and log the frame averages
+ */
+void stopRenderer() {
+    struct FrameRenderer *r = &frameRenderer;
     
-    // Display top 5 processes
-    int display_count = (process_count < 5) ? process_count : 5;
-    for (int i = 0; i < display_count; i++) {
-        printf("%-10d %-30s %-15lu %.2f%%\n",
-               processes[i].pid,
-               processes[i].name,
-               processes[i].total_time,
-               processes[i].cpu_percent);
+    frameBuffer.active = 0;
+    if (!r->active) {
+        return;
+    }
+    r->active = 0;
+    errorsToLog = 0;
+    setlocale(LC_CTYPE, "C");
+    if (r->tty) {
+        writeAll(STDOUT_FILENO, "\033[?25h", 6);
     }
-    printf("\n");
     
-    // Log the results
-    char log_msg[512];
-    snprintf(log_msg, sizeof(log_msg), 
-             "Top 5 processes displayed: Top process PID=%d (%s) with %lu CPU time",
-             processes[0].pid, processes[0].name, processes[0].total_time);
-    writeLog(log_msg);
+    if (frameStats.frames > 0) {
+        char log_msg[256];
+        snprintf(log_msg, sizeof(log_msg),
+                 "Rendered %lu frames: %.0f us formatting and %.0f us rendering per frame on average",
+                 frameStats.frames, frameStats.total_format_us / frameStats.frames,
+                 frameStats.total_render_us / frameStats.frames);
+        writeLog(log_msg);
+    }
 }
 
-// ==================== MAIN CONTROL & CONTINUOUS MONITORING (CONTRIBUTOR 4) ====================
+/**
+ * freeRenderer - Release the frame buffers
+ */
+void freeRenderer() {
+    stopRenderer();
+    free(frameRenderer.prev);
+    free(frameRenderer.out);
+    free(frameBuffer.data);
+    memset(&frameRenderer, 0, sizeof(frameRenderer));
+    memset(&frameBuffer, 0, sizeof(frameBuffer));
+}
+
+
+/**
+ * cleanupResources - Release descriptors and buffers held across samples
+ */
+void cleanupResources() {
+    closeProcSource(&statSource);
+    closeProcSource(&loadavgSource);
+    destroyCPUSampler(displaySampler);
+    displaySampler = NULL;
+    stopScanPool(&scanPool);
+    closeUring(&threadRing);
+    freeStatusBuffer();
+    freeProcessTable(&processTable);
+    freeStringPool(&detailPool);
+    freeTopK(&processRanking);
+    free(rankedProcesses);
+    rankedProcesses = NULL;
+    rankedCapacity = 0;
+    closePidEnumerator(&procEnumerator);
+    closeProcSource(&meminfoSource);
+    destroyDiskSampler(diskDisplaySampler);
+    diskDisplaySampler = NULL;
+    closeProcSource(&diskstatsSource);
+    destroyNetSampler(netDisplaySampler);
+    netDisplaySampler = NULL;
+    closeProcSource(&netdevSource);
+    closePressureTriggers();
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        closeProcSource(&pressureSources[r]);
+    }
+    destroyCgroupTree(cgroupDisplayTree);
+    cgroupDisplayTree = NULL;
+    freeTopK(&cgroupRanking);
+    freeRenderer();
+}
 
 /**
  * displayMenu - Display main menu
@@ -544,14 +6517,22 @@ void displayMenu() {
 		printf("\n=== SysMonitor++ Main Menu ===\n");
 		printf("1. CPU Usage\n");
 		printf("2. Memory Usage\n");
-		printf("3. Top 5 Processes\n");
-		printf("4. Continuous Monitoring\n");
-		printf("5. Exit\n");
+		printf("3. Top %d Processes\n", topCount);
+		printf("4. Disk I/O\n");
+		printf("5. Network\n");
+		printf("6. Pressure (PSI)\n");
+		printf("7. Top %d Cgroups\n", topCount);
+		printf("8. Continuous Monitoring\n");
+		printf("9. Exit\n");
 		printf("Enter your choice: ");
 
 		if (scanf("%d", &choice) != 1) {
+			if (!running || feof(stdin)) {
+				break; // Interrupted, or no more input
+			}
 			printf("Invalid input. Please enter a number.\n");
-			while (getchar() != '\n'); //clear input buffer
+			int c;
+			while ((c = getchar()) != '\n' && c != EOF); //clear input buffer
 			continue;
 		}
 
@@ -567,40 +6548,92 @@ void displayMenu() {
 				listTopProcesses();
 				break;
 			case 4:
-				continuousMonitor(2);
+				getDiskUsage();
 				break;
 			case 5:
+				getNetworkUsage();
+				break;
+			case 6:
+				getPressure();
+				break;
+			case 7:
+				listTopCgroups();
+				break;
+			case 8:
+				continuousMonitor(2);
+				break;
+			case 9:
 				running = 0;
 				writeLog("User exited from menu");
 				printf("Exiting...\n");
 				break;
 			default:
-				printf("Invalid choice. Please select 1-5.\n");
+				printf("Invalid choice. Please select 1-9.\n");
 		}
 	}
 }
 
 /**
  * continuousMonitor - Continuous monitoring mode
- * @interval: Refresh interval in seconds
+ * @interval: Refresh interval in seconds (fractions allowed, e.g. 0.1)
  * DONE: Implement by Contributor 4
+ *
+ * Each tick is composed off-screen and drawn by the differential
+ * renderer. Ticks follow a fixed schedule, so the time a tick takes is
+ * not added to the interval. Between ticks it waits on the PSI
+ * triggers, so a stall redraws the screen immediately.
  */
-void continuousMonitor(int interval) {
+void continuousMonitor(double interval) {
     writeLog("Continuous monitoring started");
+    startRenderer();
+    registerPressureTriggers();
+    int fired = 0;
+    long interval_ms = (long)(interval * 1000.0 + 0.5);
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
 
 		while(running) {
-			system("clear"); //clear terminal
+			beginFrame();
 
-			printf("=== Continuous Monitoring ===\n");
-			printf("Timestamp: %s\n\n", getCurrentTimestamp());
+			emit("=== Continuous Monitoring ===\n");
+			emit("Timestamp: %s\n\n", getCurrentTimestamp());
+			if (fired) {
+				reportPressureAlerts(fired);
+			}
 
 			getCPUUsage();
 			getMemoryUsage();
+			getPressure();
+			getDiskUsage();
+			getNetworkUsage();
 			listTopProcesses();
+			listTopCgroups();
+			reportFrameStats();
+
+			renderFrame();
 
-			sleep(interval);
+			// Next tick on the fixed schedule (an early PSI redraw keeps
+			// the deadline); a tick that overran restarts it from now
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			if (!fired) {
+				deadline.tv_sec += interval_ms / 1000;
+				deadline.tv_nsec += (interval_ms % 1000) * 1000000L;
+				if (deadline.tv_nsec >= 1000000000L) {
+					deadline.tv_sec++;
+					deadline.tv_nsec -= 1000000000L;
+				}
+			}
+			long remaining = (deadline.tv_sec - now.tv_sec) * 1000L + (deadline.tv_nsec - now.tv_nsec) / 1000000L;
+			if (remaining < 0) {
+				deadline = now;
+				remaining = 0;
+			}
+			fired = waitForPressure((int)remaining);
 		}
 
+	stopRenderer();
+	closePressureTriggers();
 	writeLog("Continuous monitoring stopped");
 }
 /**
@@ -609,8 +6642,14 @@ void continuousMonitor(int interval) {
  * 
  */
 int main(int argc, char *argv[]) {
-    // Set up signal handler
-    signal(SIGINT, handleSignal);
+    // Set up signal handlers (no SA_RESTART, so blocking calls return EINTR)
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handleSignal;
+    sa.sa_flags = SA_RESETHAND;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
     
     logFile = fopen("syslog.txt","a");
     if (logFile == NULL) {
@@ -620,48 +6659,167 @@ int main(int argc, char *argv[]) {
     }
 
 
-    if (argc == 1) {
-	displayMenu();
+    const char *mode = NULL;
+    const char *interval_arg = NULL;
+    const char *bench = NULL;
+    int show_help = 0;
+    int bad_option = 0;
+    int opt;
+
+    opterr = 0; // Report bad options ourselves
+    while ((opt = getopt(argc, argv, "hm:c:u:b:n:k:t:i:s:p:")) != -1) {
+	switch (opt) {
+		case 'h':
+			show_help = 1;
+			break;
+		case 'm':
+			mode = optarg;
+			break;
+		case 'c':
+			interval_arg = optarg;
+			break;
+		case 'b':
+			bench = optarg;
+			break;
+		case 'k': {
+			char *end;
+			errno = 0;
+			long count = strtol(optarg, &end, 10);
+			if (end == optarg || *end != '\0' || errno != 0 || count < 1 || count > TOP_COUNT_MAX) {
+				printf("Error: process count must be an integer from 1 to %d\n", TOP_COUNT_MAX);
+				bad_option = 1;
+			} else {
+				topCount = (int)count;
+			}
+			break;
+		}
+		case 't': {
+			char *end;
+			errno = 0;
+			long threads = strtol(optarg, &end, 10);
+			if (end == optarg || *end != '\0' || errno != 0 || threads < 0 || threads > SCAN_THREADS_MAX) {
+				printf("Error: thread count must be an integer from 0 to %d\n", SCAN_THREADS_MAX);
+				bad_option = 1;
+			} else {
+				scanThreads = (int)threads;
+			}
+			break;
+		}
+		case 'i':
+			if (parseCollectBackend(optarg) != 0) {
+				printf("Error: Invalid backend '%s'. Use -i [sync|uring]\n", optarg);
+				bad_option = 1;
+			}
+			break;
+		case 's':
+			if (parseProcessSort(optarg) != 0) {
+				printf("Error: Invalid sort key '%s'. Use -s [cpu|mem|pss|minflt|majflt|cswch|nvcswch]\n", optarg);
+				bad_option = 1;
+			}
+			break;
+		case 'p': {
+			// 1 ms up to the whole window; 0 turns the triggers off
+			char *end;
+			errno = 0;
+			long stall = strtol(optarg, &end, 10);
+			if (end == optarg || *end != '\0' || errno != 0 || stall < 0 || stall > PSI_WINDOW_US / 1000) {
+				printf("Error: stall threshold must be an integer from 1 to %d ms (0 = timed only)\n",
+				       PSI_WINDOW_US / 1000);
+				bad_option = 1;
+			} else {
+				pressureStallMs = (int)stall;
+			}
+			break;
+		}
+		case 'n':
+			if (parseCpuNormalize(optarg) != 0) {
+				printf("Error: Invalid normalization '%s'. Use -n [core|machine]\n", optarg);
+				bad_option = 1;
+			}
+			break;
+		case 'u':
+			if (parseBusyModes(optarg) != 0) {
+				printf("Error: Invalid CPU mode list '%s'. Use -h for valid modes\n", optarg);
+				bad_option = 1;
+			}
+			break;
+		default:
+			bad_option = 1;
+	}
+    }
+
+    if (bad_option || optind < argc ||
+        (mode != NULL) + (interval_arg != NULL) + (bench != NULL) > 1) {
+	printf("Invalid option: Use -h for help.\n");
     }
 
-    else if (argc == 2 && strcmp(argv[1], "-h") == 0) {
+    else if (show_help) {
 	displayHelp();
     }
 
     //mode selection
-    else if (argc == 3 && strcmp(argv[1], "-m") == 0){
-	if (strcmp(argv[2], "cpu") == 0) {
+    else if (mode != NULL) {
+	if (strcmp(mode, "cpu") == 0) {
 		getCPUUsage();
 		sleep(1);
 		getCPUUsage();
 	}
-	else if (strcmp(argv[2], "mem") == 0) {
+	else if (strcmp(mode, "mem") == 0) {
 		getMemoryUsage();
 	}
-	else if (strcmp(argv[2], "proc") == 0) {
+	else if (strcmp(mode, "proc") == 0) {
 		listTopProcesses();
 	}
+	else if (strcmp(mode, "disk") == 0) {
+		getDiskUsage();
+		sleep(1);
+		getDiskUsage();
+	}
+	else if (strcmp(mode, "net") == 0) {
+		getNetworkUsage();
+		sleep(1);
+		getNetworkUsage();
+	}
+	else if (strcmp(mode, "psi") == 0) {
+		getPressure();
+	}
+	else if (strcmp(mode, "cgroup") == 0) {
+		listTopCgroups();
+	}
 	else {
-		printf("Error: Invalid Parameter. Use -m [cpu|mem|proc]\n");
+		printf("Error: Invalid Parameter. Use -m [cpu|mem|proc|disk|net|psi|cgroup]\n");
 	}
 }
 
 	//continuous mode
-	else if (argc == 3 && strcmp(argv[1], "-c") == 0) {
-		int interval = atoi(argv[2]);
+	else if (interval_arg != NULL) {
+		char *end;
+		double interval = strtod(interval_arg, &end);
 
-		if (interval <= 0){
-			printf("Error: interval must be a positive integer\n");
+		if (end == interval_arg || *end != '\0' || !(interval >= 0.05 && interval <= 86400)) {
+			printf("Error: interval must be 0.05-86400 seconds\n");
 		}
 		else {
 			continuousMonitor(interval);
 		}
 	}
 
+	//benchmark mode
+	else if (bench != NULL) {
+		runBenchmark(bench);
+	}
+
 	else {
-		printf("Invalid option: Use -h for help.\n");
+		displayMenu();
+	}
+
+	if (caughtSignal) {
+		printf("\n\nExiting... Saving log.\n");
+		writeLog(caughtSignal == SIGINT ? "SIGINT received" : "SIGTERM received");
 	}
 
+	cleanupResources();
+
 	if (logFile != NULL) {
 		writeLog("Session ended");
 		fclose(logFile);
@@ -674,7 +6832,7 @@ int main(int argc, char *argv[]) {
  * COMPILATION AND TESTING:
  * 
  * Compile:
- *   gcc sysmonitor.c -o sysmonitor
+ *   gcc sysmonitor.c -o sysmonitor -pthread
  * 
  * Test CPU module:
  *   ./sysmonitor           # Default test mode